@@ -1,25 +1,56 @@
 #ifndef DIP_ABSTRACTMODEL_H
 #define DIP_ABSTRACTMODEL_H
 
+#include <initializer_list>
 #include <memory>
 #include <utility>
 #include <NTL/ZZ.h>
 #include <sstream>
-#include <boost/serialization/serialization.hpp>
-#include <boost/serialization/split_member.hpp>
 
 
+#include "BarrettReducer.h"
 #include "Options.h"
 
+namespace wire {
+    /// Binary format for MPI. Values are residues modulo N, so every value is written to fixed slot of NumBytes(N)
+    /// bytes with least significant byte first.
+    inline unsigned char *write(unsigned char *buffer, long slot, std::initializer_list<const NTL::ZZ *> values) {
+        for (const auto *value : values) {
+            NTL::BytesFromZZ(buffer, *value, slot);
+            buffer += slot;
+        }
+        return buffer;
+    }
+
+    inline const unsigned char *read(const unsigned char *buffer, long slot, std::initializer_list<NTL::ZZ *> values) {
+        for (auto *value : values) {
+            NTL::ZZFromBytes(*value, buffer, slot);
+            buffer += slot;
+        }
+        return buffer;
+    }
+}
+
 struct ProjectivePoint {
-    friend class boost::serialization::access;
     /// This struct represents point in projective coordinate system P = (X : Y: Z)
     NTL::ZZ x{0};
     NTL::ZZ y{1};
     NTL::ZZ z{0};
+    /// Fourth coordinate, it is used only by models in four-dimensional space (Jacobi intersection)
+    NTL::ZZ t{0};
 
     bool operator==(const ProjectivePoint &rhs) const {
-        return x == rhs.x && y == rhs.y && z == rhs.z;
+        return x == rhs.x && y == rhs.y && z == rhs.z && t == rhs.t;
+    }
+    /// Number of values in binary format
+    static constexpr long WIRE_VALUES = 4;
+    /// Writes all coordinates in binary format and returns end of written data
+    unsigned char *to_bytes(unsigned char *buffer, long slot) const {
+        return wire::write(buffer, slot, {&x, &y, &z, &t});
+    }
+    /// Reads all coordinates in binary format and returns end of read data
+    const unsigned char *from_bytes(const unsigned char *buffer, long slot) {
+        return wire::read(buffer, slot, {&x, &y, &z, &t});
     }
     /// Help function for getting point coordinates
     [[nodiscard]] std::string get_str() const {
@@ -27,32 +58,6 @@ struct ProjectivePoint {
         oss << "(" << x << ", " << y << ", " << z << ")";
         return oss.str();
     }
-    /// This function is used for serialization operation
-    template<class Archive>
-    void save(Archive &ar, const unsigned int version) const {
-        std::ostringstream buffer;
-
-        buffer << x;
-        ar & buffer.str();
-        buffer.str("");
-
-        buffer << y;
-        ar & buffer.str();
-    }
-    /// This function is used for loading serialized data
-    template<class Archive>
-    void load(Archive &ar, const unsigned int version) {
-        std::string buffer;
-
-        ar & buffer;
-        NTL::conv(x, buffer.c_str());
-        buffer.clear();
-
-        ar & buffer;
-        NTL::conv(y, buffer.c_str());
-    }
-    BOOST_SERIALIZATION_SPLIT_MEMBER()
-
 };
 
 class AbstractModel {
@@ -87,12 +92,58 @@ public:
     [[nodiscard]] virtual bool is_infinity_point(const ProjectivePoint &point) const noexcept {
         return point == INFINITY_POINT;
     }
+    /// Returns neutral point of model
+    [[nodiscard]] const ProjectivePoint &infinity_point() const noexcept {
+        return INFINITY_POINT;
+    }
     /// Abstract method for converting projective system to affine system
     [[nodiscard]] virtual NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept = 0;
+    /// Returns coordinate tested by try_get_factor, it is used for accumulating more points before one GCD
+    [[nodiscard]] virtual const NTL::ZZ &factor_coordinate(const ProjectivePoint &point) const noexcept {
+        return point.z;
+    }
+    /// Returns true when factor coordinate stays divisible by factor once point is neutral modulo this factor.
+    /// It holds when coordinate is zero in every representation of neutral point, divisibility of other models
+    /// can be transient, so backtracking must not skip any part of phase for them.
+    [[nodiscard]] virtual bool sticky_factor_coordinate() const noexcept {
+        return false;
+    }
+    /// Returns a * b mod N for residues a and b, Barrett reducer is used for large modulus
+    [[nodiscard]] NTL::ZZ mul_mod(const NTL::ZZ &a, const NTL::ZZ &b) const {
+        return _reducer ? _reducer->mul(a, b) : NTL::MulMod(a, b, *_options->composite_number);
+    }
 
 protected:
     /// Options from command-line
     std::shared_ptr<Options> _options;
+    /// Every product is reduced, it is set for moduli with at least Options::large_modulus_threshold bits
+    bool _bounded = false;
+    /// Reducer with cached reciprocal of modulus, it is set only for moduli with at least Options::barrett_threshold bits
+    std::shared_ptr<const BarrettReducer> _reducer;
+
+    /// Chooses reduction for current composite number, models call it whenever they set curve
+    void _prepare_reducer() {
+        const auto &n = *_options->composite_number;
+        const auto bits = NTL::NumBits(n);
+        _bounded = _options->large_modulus_threshold > 0 && bits >= _options->large_modulus_threshold;
+        if (_options->barrett_threshold <= 0 || bits < _options->barrett_threshold) {
+            _reducer.reset();
+        } else if (!_reducer || _reducer->modulus() != n) {
+            _reducer = std::make_shared<const BarrettReducer>(n);
+        }
+    }
+    /// Product in formulas. For large modulus every product is reduced, so operands stay of size of modulus and
+    /// multiplications do not grow, for small modulus product is left unreduced and only results are reduced.
+    [[nodiscard]] NTL::ZZ _mul(const NTL::ZZ &a, const NTL::ZZ &b) const {
+        if (_reducer) {
+            return _reducer->mul(a, b);
+        }
+        return _bounded ? a * b % *_options->composite_number : a * b;
+    }
+    /// Returns x mod N in [0, N)
+    [[nodiscard]] NTL::ZZ _reduce(const NTL::ZZ &x) const {
+        return _reducer ? _reducer->reduce(x) : x % *_options->composite_number;
+    }
     /// Stores value of infinity (neutral) point on elliptic curve
     ProjectivePoint INFINITY_POINT;
 };
@@ -0,0 +1,39 @@
+#include "BarrettReducer.h"
+
+BarrettReducer::BarrettReducer(NTL::ZZ modulus) : _modulus(std::move(modulus)), _bits(NTL::NumBits(_modulus)) {
+    _reciprocal = (NTL::ZZ(1) << (2 * _bits + SLACK)) / _modulus;
+}
+
+void BarrettReducer::reduce(NTL::ZZ &result, const NTL::ZZ &x) const {
+    /// Quotient estimate ((|x| >> (k - 1)) * reciprocal) >> (k + SLACK + 1) is at most 2 smaller than real quotient
+    if (NTL::NumBits(x) > 2 * _bits + SLACK) {
+        NTL::rem(result, x, _modulus);
+        return;
+    }
+    NTL::ZZ quotient;
+    NTL::abs(result, x);
+    NTL::RightShift(quotient, result, _bits - 1);
+    NTL::mul(quotient, quotient, _reciprocal);
+    NTL::RightShift(quotient, quotient, _bits + SLACK + 1);
+    NTL::mul(quotient, quotient, _modulus);
+    NTL::sub(result, result, quotient);
+    while (result >= _modulus) {
+        NTL::sub(result, result, _modulus);
+    }
+    if (NTL::sign(x) < 0 && !NTL::IsZero(result)) {
+        NTL::sub(result, _modulus, result);
+    }
+}
+
+NTL::ZZ BarrettReducer::reduce(const NTL::ZZ &x) const {
+    NTL::ZZ result;
+    reduce(result, x);
+    return result;
+}
+
+NTL::ZZ BarrettReducer::mul(const NTL::ZZ &a, const NTL::ZZ &b) const {
+    NTL::ZZ product, result;
+    NTL::mul(product, a, b);
+    reduce(result, product);
+    return result;
+}
@@ -0,0 +1,37 @@
+#ifndef DIP_BARRETTREDUCER_H
+#define DIP_BARRETTREDUCER_H
+
+#include <NTL/ZZ.h>
+
+class BarrettReducer final {
+    /// Barrett reduction modulo fixed N. Reciprocal floor(4^k * 2^SLACK / N) is computed once, so every reduction
+    /// costs two multiplications and a few subtractions instead of long division. Values up to 4^k * 2^SLACK
+    /// (products of two residues and their small multiples) are reduced this way, bigger values by division.
+public:
+    explicit BarrettReducer(NTL::ZZ modulus);
+
+    /// Extra bits of input, so sums and differences of few products can be reduced without normalization
+    static constexpr long SLACK = 64;
+
+    /// Stores x mod N to result, result is in [0, N) also for negative x. Result can not alias x.
+    void reduce(NTL::ZZ &result, const NTL::ZZ &x) const;
+
+    /// Returns x mod N in [0, N)
+    [[nodiscard]] NTL::ZZ reduce(const NTL::ZZ &x) const;
+
+    /// Returns a * b mod N in [0, N)
+    [[nodiscard]] NTL::ZZ mul(const NTL::ZZ &a, const NTL::ZZ &b) const;
+
+    [[nodiscard]] const NTL::ZZ &modulus() const noexcept {
+        return _modulus;
+    }
+
+private:
+    NTL::ZZ _modulus;
+    /// Number of bits of modulus
+    long _bits;
+    NTL::ZZ _reciprocal;
+};
+
+
+#endif //DIP_BARRETTREDUCER_H
@@ -0,0 +1,99 @@
+#include "BatchGCD.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+std::vector<NTL::ZZ> BatchGCD::shared_divisors(const std::vector<NTL::ZZ> &numbers) const {
+    /// Zero would be modulus of remainder tree
+    if (std::any_of(numbers.begin(), numbers.end(), [](const NTL::ZZ &n) { return n < 1; })) {
+        throw std::invalid_argument("Batch GCD inputs must be positive");
+    }
+    if (numbers.empty()) {
+        return {};
+    }
+    const std::size_t chunks = (numbers.size() + _chunk_size - 1) / _chunk_size;
+    auto chunk_of = [&](std::size_t chunk) {
+        auto begin = numbers.begin() + static_cast<long>(chunk * _chunk_size);
+        auto end = numbers.begin() + static_cast<long>(std::min(numbers.size(), (chunk + 1) * _chunk_size));
+        return std::vector<NTL::ZZ>(begin, end);
+    };
+
+    /// First pass keeps only root of every chunk
+    std::vector<NTL::ZZ> products(chunks);
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        products[chunk] = _product_tree(chunk_of(chunk)).back().front();
+    }
+
+    /// Product P of all inputs is reduced modulo square of every chunk product by tree over chunk products
+    std::vector<NTL::ZZ> chunk_remainders;
+    {
+        auto top = _product_tree(products);
+        chunk_remainders = _remainders(top, top.back().front(), true);
+    }
+
+    std::vector<NTL::ZZ> result(numbers.size());
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        auto tree = _product_tree(chunk_of(chunk));
+        const auto &leaves = tree.front();
+
+        /// n^2 divides square of chunk product, so descent gives P mod n^2 and (P mod n^2) / n = (P / n) mod n
+        auto accumulators = _remainders(tree, chunk_remainders[chunk], true);
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < leaves.size(); i++) {
+            result[chunk * _chunk_size + i] = NTL::GCD(accumulators[i] / leaves[i], leaves[i]);
+        }
+    }
+
+    /// Number sharing all its factors is split by GCD with other inputs. Only inputs with shared divisor
+    /// can split it, so this is quadratic only in their count.
+    std::vector<std::size_t> sharing;
+    for (std::size_t i = 0; i < numbers.size(); i++) {
+        if (result[i] > 1) {
+            sharing.push_back(i);
+        }
+    }
+    for (auto i : sharing) {
+        if (result[i] != numbers[i]) {
+            continue;
+        }
+        for (auto j : sharing) {
+            auto divisor = NTL::GCD(numbers[i], numbers[j]);
+            if (j != i && divisor > 1 && divisor < numbers[i]) {
+                result[i] = divisor;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+BatchGCD::Tree BatchGCD::_product_tree(std::vector<NTL::ZZ> leaves) {
+    Tree tree;
+    tree.push_back(std::move(leaves));
+    while (tree.back().size() > 1) {
+        const auto &level = tree.back();
+        std::vector<NTL::ZZ> next((level.size() + 1) / 2);
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < next.size(); i++) {
+            next[i] = 2 * i + 1 < level.size() ? level[2 * i] * level[2 * i + 1] : level[2 * i];
+        }
+        tree.push_back(std::move(next));
+    }
+    return tree;
+}
+
+std::vector<NTL::ZZ> BatchGCD::_remainders(const Tree &tree, const NTL::ZZ &value, bool squared) {
+    /// Goes from root to leaves, every node is reduced modulo its own value (or its square)
+    auto modulus = [squared](const NTL::ZZ &node) { return squared ? node * node : node; };
+    std::vector<NTL::ZZ> current{value % modulus(tree.back().front())};
+    for (auto level = tree.rbegin() + 1; level != tree.rend(); ++level) {
+        std::vector<NTL::ZZ> next(level->size());
+        #pragma omp parallel for
+        for (std::size_t i = 0; i < next.size(); i++) {
+            next[i] = current[i / 2] % modulus((*level)[i]);
+        }
+        current = std::move(next);
+    }
+    return current;
+}
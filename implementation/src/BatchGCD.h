@@ -0,0 +1,38 @@
+#ifndef DIP_BATCHGCD_H
+#define DIP_BATCHGCD_H
+
+#include <NTL/ZZ.h>
+
+#include <vector>
+
+class BatchGCD final {
+    /// Bernstein's batch GCD. It computes gcd(n_i, product of all other inputs) for all inputs at once
+    /// by product tree and remainder tree in quasi-linear time.
+    /// Inputs are processed in chunks, so only product tree of one chunk and products of chunks are in memory.
+public:
+    explicit BatchGCD(std::size_t chunk_size = DEFAULT_CHUNK_SIZE) : _chunk_size(chunk_size ? chunk_size : 1) {
+    }
+
+    /// Default number of inputs in one chunk
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    /// Returns for every input its divisor shared with some other input, 1 when it shares nothing.
+    /// Input is returned itself only when it can not be split by other inputs (e.g. it is duplicate).
+    /// Inputs sharing all their factors are split by pairwise GCD with other inputs with shared divisor,
+    /// which is quadratic in number of such inputs. Throws std::invalid_argument when some input is not positive.
+    [[nodiscard]] std::vector<NTL::ZZ> shared_divisors(const std::vector<NTL::ZZ> &numbers) const;
+
+private:
+    std::size_t _chunk_size;
+
+    using Tree = std::vector<std::vector<NTL::ZZ>>;
+
+    /// Builds product tree, first level are leaves and last level is root
+    [[nodiscard]] static Tree _product_tree(std::vector<NTL::ZZ> leaves);
+
+    /// Computes value modulo every leaf (or modulo square of leaf when squared is set)
+    [[nodiscard]] static std::vector<NTL::ZZ> _remainders(const Tree &tree, const NTL::ZZ &value, bool squared);
+};
+
+
+#endif //DIP_BATCHGCD_H
@@ -1,4 +1,5 @@
 #include "EdwardsModel.h"
+#include "Trace.h"
 
 ProjectivePoint EdwardsModel::add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const {
     /// This function uses formulas for calculation point addition on Edwards curve as described in thesis
@@ -14,18 +15,18 @@ ProjectivePoint EdwardsModel::add_points(const ProjectivePoint &P, const Project
         return double_point(P);
     }
 
-    NTL::ZZ A = P.z * Q.z;
-    NTL::ZZ B = A * A;
-    NTL::ZZ C = P.x * Q.x;
-    NTL::ZZ D = P.y * Q.y;
-    NTL::ZZ E = C * D;
+    NTL::ZZ A = _mul(P.z, Q.z);
+    NTL::ZZ B = _mul(A, A);
+    NTL::ZZ C = _mul(P.x, Q.x);
+    NTL::ZZ D = _mul(P.y, Q.y);
+    NTL::ZZ E = _mul(_ecc.d, _mul(C, D));
     NTL::ZZ F = B - E;
     NTL::ZZ G = B + E;
 
     return {
-            (A * F * ((P.x + P.y) * (Q.x + Q.y) - C - D)) % *_ecc.modulus,
-            (A * G * (D - C)) % *_ecc.modulus,
-            (F * G) % *_ecc.modulus
+            _reduce(_mul(A, F) * (_mul(P.x + P.y, Q.x + Q.y) - C - D)),
+            _reduce(_mul(A, G) * (D - C)),
+            _reduce(F * G)
     };
 }
 
@@ -35,25 +36,27 @@ ProjectivePoint EdwardsModel::double_point(const ProjectivePoint &P) const {
         return P;
     }
 
-    NTL::ZZ B = (P.x + P.y) * (P.x + P.y);
-    NTL::ZZ C = P.x * P.x;
-    NTL::ZZ D = P.y * P.y;
+    NTL::ZZ B = _mul(P.x + P.y, P.x + P.y);
+    NTL::ZZ C = _mul(P.x, P.x);
+    NTL::ZZ D = _mul(P.y, P.y);
     NTL::ZZ F = C + D;
-    NTL::ZZ H = P.z * P.z;
+    NTL::ZZ H = _mul(P.z, P.z);
     NTL::ZZ J = F - (H << 1);
 
     return {
-            ((B - C - D) * J) % *_ecc.modulus,
-            (F * (C - D)) % *_ecc.modulus,
-            (F * J) % *_ecc.modulus,
+            _reduce((B - C - D) * J),
+            _reduce(F * (C - D)),
+            _reduce(F * J),
     };
 }
 
 ProjectivePoint EdwardsModel::generate_elliptic_curve() {
+    TRACE_SPAN(_options->tracer, "generate curve");
     ProjectivePoint ret;
     ret.z = 1;
     _ecc.d = 1;
     _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
     /// While d = 1 then generate new value of d.
     while (_ecc.d < 2) {
         ret.x = NTL::RandomBnd(*_ecc.modulus);
@@ -77,16 +80,17 @@ ProjectivePoint EdwardsModel::generate_elliptic_curve() {
 }
 
 NTL::ZZ EdwardsModel::try_get_factor(const ProjectivePoint &point) const noexcept {
-    /// Tries to convert (X : Y : Z) to (X/Z : Y/Z)
-    return NTL::GCD(point.z, *_ecc.modulus);
+    /// Neutral point (0 : 1) and point (0 : -1) of order 2 have X = 0, Z is never zero for complete addition law
+    return NTL::GCD(point.x, *_ecc.modulus);
 }
 
 EdwardsModel::EllipticCurve EdwardsModel::get_elliptic_curve() const noexcept {
     return _ecc;
 }
 
-void EdwardsModel::set_elliptic_curve(const EdwardsModel::EllipticCurve &curve) noexcept {
+void EdwardsModel::set_elliptic_curve(const EdwardsModel::EllipticCurve &curve) {
     _ecc = curve;
     /// Modulus is set only to composite number value from command-line
     _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
 }
@@ -4,41 +4,31 @@
 #include "AbstractModel.h"
 
 #include <set>
-#include <sstream>
-#include <boost/serialization/serialization.hpp>
 
 class EdwardsModel final : public AbstractModel {
     public:
 
     struct EllipticCurve {
         /// This struct represents elliptic curve in Edwards form x^2 + y^2 = 1 + dx^2y^2
-        friend class boost::serialization::access;
-
         NTL::ZZ d;
 
         std::shared_ptr<NTL::ZZ> modulus = nullptr;
 
-        /// Auxiliary function for std::set, which requires this operator
-        bool operator<(const EllipticCurve &rhs) const {
-            return d < rhs.d;
+        /// Number of values in binary format
+        static constexpr long WIRE_VALUES = 1;
+        /// Writes curve parameters in binary format and returns end of written data
+        unsigned char *to_bytes(unsigned char *buffer, long slot) const {
+            return wire::write(buffer, slot, {&d});
         }
-        /// This function is used for serialization operation
-        template<class Archive>
-        void save(Archive &ar, const unsigned int version) const {
-            std::stringstream buffer;
-
-            buffer << d;
-            ar & buffer.str();
+        /// Reads curve parameters in binary format and returns end of read data
+        const unsigned char *from_bytes(const unsigned char *buffer, long slot) {
+            return wire::read(buffer, slot, {&d});
         }
-        /// This function is used for loading serialized data
-        template<class Archive>
-        void load(Archive &ar, const unsigned int version) {
-            std::string value;
 
-            ar & value;
-            NTL::conv(d, value.c_str());
+        /// Auxiliary function for std::set, which requires this operator
+        bool operator<(const EllipticCurve &rhs) const {
+            return d < rhs.d;
         }
-        BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
     explicit EdwardsModel(std::shared_ptr<Options> options) : AbstractModel(std::move(options), {
@@ -55,14 +45,23 @@ class EdwardsModel final : public AbstractModel {
     /// This function implements generation of new elliptic curve and returns point on this curve
     ProjectivePoint generate_elliptic_curve() override;
 
-    /// This function tries to find inversion of Z point. It can return divisor of modulus or another value (1 or modulus)
+    /// This function tests X coordinate of point. It can return divisor of modulus or another value (1 or modulus)
     [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override;
 
+    [[nodiscard]] const NTL::ZZ &factor_coordinate(const ProjectivePoint &point) const noexcept override {
+        return point.x;
+    }
+
+    /// Multiples of point which is (0 : 1) or (0 : -1) modulo factor keep X divisible by this factor
+    [[nodiscard]] bool sticky_factor_coordinate() const noexcept override {
+        return true;
+    }
+
     /// This function gets new elliptic curve
     [[nodiscard]] EllipticCurve get_elliptic_curve() const noexcept;
 
     /// This function sets new elliptic curve
-    void set_elliptic_curve(const EllipticCurve &curve) noexcept;
+    void set_elliptic_curve(const EllipticCurve &curve);
 
 private:
 
@@ -0,0 +1,167 @@
+#include "EffortDatabase.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+const std::vector<EffortDatabase::Level> EffortDatabase::LEVELS = {
+        {15, 2000, 25},
+        {20, 11000, 90},
+        {25, 50000, 300},
+        {30, 250000, 700},
+        {35, 1000000, 1800},
+        {40, 3000000, 5100},
+        {45, 11000000, 10600},
+};
+
+namespace {
+    /// File lock is owned by process, threads of one process are serialized by mutex
+    std::mutex database_mutex;
+
+    std::string key(const NTL::ZZ &n) {
+        std::ostringstream buffer;
+        buffer << n;
+        return buffer.str();
+    }
+}
+
+NTL::ZZ EffortDatabase::Record::factor_of(const NTL::ZZ &n) const {
+    NTL::ZZ factor;
+    for (const auto &value : factors) {
+        NTL::conv(factor, value.c_str());
+        if (factor > 1 && factor < n && n % factor == 0) {
+            return factor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+bool EffortDatabase::Record::has_method(const std::string &method) const {
+    return std::find(methods.begin(), methods.end(), method) != methods.end();
+}
+
+template<class Update>
+void EffortDatabase::_update(Update update) const {
+    std::lock_guard<std::mutex> guard(database_mutex);
+    /// Lock file has to exist before it is locked
+    const auto lock_path = _path + ".lock";
+    std::ofstream(lock_path, std::ios::app);
+    boost::interprocess::file_lock file_lock(lock_path.c_str());
+    boost::interprocess::scoped_lock<boost::interprocess::file_lock> lock(file_lock);
+
+    Records records;
+    {
+        std::ifstream input(_path);
+        if (input.peek() != std::ifstream::traits_type::eof()) {
+            boost::archive::text_iarchive ar(input);
+            ar >> records;
+        }
+    }
+    if (update(records)) {
+        /// Database is replaced at once, so it is never left half-written
+        const auto temporary = _path + ".tmp";
+        bool written;
+        {
+            std::ofstream output(temporary, std::ios::trunc);
+            if (output) {
+                boost::archive::text_oarchive ar(output);
+                ar << records;
+            }
+            output.close();
+            written = !output.fail();
+        }
+        if (!written || std::rename(temporary.c_str(), _path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Can not save effort database " + _path);
+        }
+    }
+}
+
+EffortDatabase::Record EffortDatabase::find(const NTL::ZZ &n) const {
+    Record record;
+    _update([&](Records &records) {
+        auto found = records.find(key(n));
+        if (found != records.end()) {
+            record = found->second;
+        }
+        return false;
+    });
+    return record;
+}
+
+void EffortDatabase::add_factor(const NTL::ZZ &n, const NTL::ZZ &factor) {
+    _update([&](Records &records) {
+        auto &factors = records[key(n)].factors;
+        if (std::find(factors.begin(), factors.end(), key(factor)) != factors.end()) {
+            return false;
+        }
+        factors.push_back(key(factor));
+        return true;
+    });
+}
+
+void EffortDatabase::add_seed(const NTL::ZZ &n, unsigned long seed) {
+    _update([&](Records &records) {
+        records[key(n)].seeds.push_back(seed);
+        return true;
+    });
+}
+
+void EffortDatabase::add_curves(const NTL::ZZ &n, const std::string &model, long bound, unsigned long curves) {
+    _update([&](Records &records) {
+        records[key(n)].curves[model][bound] += curves;
+        return curves != 0;
+    });
+}
+
+void EffortDatabase::add_method(const NTL::ZZ &n, const std::string &method) {
+    _update([&](Records &records) {
+        auto &record = records[key(n)];
+        if (record.has_method(method)) {
+            return false;
+        }
+        record.methods.push_back(method);
+        return true;
+    });
+}
+
+std::string EffortDatabase::method_key(const std::string &method, const NTL::ZZ &bound, const NTL::ZZ &bound2) {
+    std::ostringstream buffer;
+    buffer << method << ' ' << bound << ' ' << bound2;
+    return buffer.str();
+}
+
+std::pair<EffortDatabase::Level, unsigned long> EffortDatabase::next_level(const Record &record,
+                                                                          const std::string &model) {
+    /// Curves with bigger bound count also for smaller levels
+    auto tried = record.curves.find(model);
+    for (const auto &level : LEVELS) {
+        unsigned long done = 0;
+        if (tried != record.curves.end()) {
+            for (auto it = tried->second.lower_bound(level.bound); it != tried->second.end(); ++it) {
+                done += it->second;
+            }
+        }
+        if (done < level.curves) {
+            return {level, level.curves - done};
+        }
+    }
+    return {LEVELS.back(), 0};
+}
+
+unsigned long EffortDatabase::fresh_seed(const Record &record) {
+    std::random_device device;
+    unsigned long seed;
+    do {
+        seed = (static_cast<unsigned long>(device()) << 32u) ^ device();
+    } while (std::find(record.seeds.begin(), record.seeds.end(), seed) != record.seeds.end());
+    return seed;
+}
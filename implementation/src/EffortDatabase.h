@@ -0,0 +1,101 @@
+#ifndef DIP_EFFORTDATABASE_H
+#define DIP_EFFORTDATABASE_H
+
+#include <NTL/ZZ.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/version.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+class EffortDatabase final {
+    /// File-backed store of work done on composite numbers. File is read and rewritten under file lock
+    /// for every change, so more dip processes can share one database.
+public:
+    struct Record {
+        /// This struct stores everything known about one composite number
+        friend class boost::serialization::access;
+
+        /// Found factors in decimal form
+        std::vector<std::string> factors;
+        /// Number of tried curves for every model and stage 1 bound
+        std::map<std::string, std::map<long, unsigned long>> curves;
+        /// Seeds of random generator used by previous runs
+        std::vector<unsigned long> seeds;
+        /// Runs of other methods (p-1, p+1, quadratic sieve) which finished without factor, see method_key
+        std::vector<std::string> methods;
+
+        /// Returns known proper divisor of n or 0
+        [[nodiscard]] NTL::ZZ factor_of(const NTL::ZZ &n) const;
+
+        /// Returns true when method with given key was finished without factor
+        [[nodiscard]] bool has_method(const std::string &method) const;
+
+        /// This function is used for serialization operation, records of version 0 have no methods
+        template<class Archive>
+        void serialize(Archive &ar, const unsigned int version) {
+            ar & factors;
+            ar & curves;
+            ar & seeds;
+            if (version >= 1) {
+                ar & methods;
+            }
+        }
+    };
+
+    struct Level {
+        /// Stage 1 bound and expected number of curves for finding factor of given size (table of GMP-ECM)
+        long digits;
+        long bound;
+        unsigned long curves;
+    };
+
+    static const std::vector<Level> LEVELS;
+
+    explicit EffortDatabase(std::string path) : _path(std::move(path)) {
+    }
+
+    /// Returns record of n, record is empty when n was never factorized
+    [[nodiscard]] Record find(const NTL::ZZ &n) const;
+
+    /// This function stores found factor of n
+    void add_factor(const NTL::ZZ &n, const NTL::ZZ &factor);
+
+    /// This function stores seed used for new curves of n
+    void add_seed(const NTL::ZZ &n, unsigned long seed);
+
+    /// This function adds tried curves of model with stage 1 bound
+    void add_curves(const NTL::ZZ &n, const std::string &model, long bound, unsigned long curves);
+
+    /// This function stores method which was finished without factor
+    void add_method(const NTL::ZZ &n, const std::string &method);
+
+    /// Returns key of method run with bounds B1 and B2 from options (0 means default bound of method)
+    [[nodiscard]] static std::string method_key(const std::string &method, const NTL::ZZ &bound, const NTL::ZZ &bound2);
+
+    /// Returns first level which was not finished for model and number of curves left on it,
+    /// when all levels are finished, it returns last level with 0 (unlimited) curves
+    [[nodiscard]] static std::pair<Level, unsigned long> next_level(const Record &record, const std::string &model);
+
+    /// Returns seed which is not in record
+    [[nodiscard]] static unsigned long fresh_seed(const Record &record);
+
+private:
+    std::string _path;
+
+    using Records = std::map<std::string, Record>;
+
+    /// Loads all records, calls update on them and saves them, everything under file lock.
+    /// Throws std::runtime_error when database can not be saved.
+    template<class Update>
+    void _update(Update update) const;
+};
+
+BOOST_CLASS_VERSION(EffortDatabase::Record, 1)
+
+
+#endif //DIP_EFFORTDATABASE_H
@@ -0,0 +1,424 @@
+#include "Factorizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <omp.h>
+#include <boost/mpi/collectives.hpp>
+
+#include "BatchGCD.h"
+#include "Lenstra.h"
+#include "EdwardsModel.h"
+#include "HessianModel.h"
+#include "JacobiIntersectionModel.h"
+#include "PollardPM1.h"
+#include "QuadraticSieve.h"
+#include "WeierstrassModel.h"
+#include "WilliamsPP1.h"
+
+void Factorizer::Task::cancel() noexcept {
+    _cancelled->store(true);
+}
+
+Factorizer::Factorizer(std::shared_ptr<Options> options, std::shared_ptr<ThreadPool> pool)
+    : _options(std::move(options)), _pool(std::move(pool)) {
+    if (!_pool) {
+        _pool = std::make_shared<ThreadPool>(1);
+    }
+}
+
+Factorizer::~Factorizer() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto &task : _tasks) {
+        if (auto cancelled = task.lock()) {
+            cancelled->store(true);
+        }
+    }
+}
+
+Factorizer::Task Factorizer::factor(const NTL::ZZ &n, unsigned long effort) {
+    Task task;
+    auto options = _options_for(n);
+    auto cancelled = task._cancelled;
+    auto progress = _progress;
+    /// std::function requires copyable callable, so promise is shared
+    auto promise = std::make_shared<std::promise<NTL::ZZ>>();
+    task.result = promise->get_future();
+    /// Workers of pool run at the same time, so OpenMP threads of sieve share processors between them
+    const int threads = std::max(1, omp_get_num_procs() / static_cast<int>(std::max<std::size_t>(1, _pool->size())));
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.erase(std::remove_if(_tasks.begin(), _tasks.end(),
+                                    [](const auto &flag) { return flag.expired(); }), _tasks.end());
+        _tasks.emplace_back(cancelled);
+    }
+    _pool->submit([options, effort, cancelled, progress, promise, threads]() {
+        omp_set_num_threads(threads);
+        try {
+            promise->set_value(_run(options, effort, *cancelled, progress));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return task;
+}
+
+std::vector<Factorizer::Task> Factorizer::factor_all(const std::vector<NTL::ZZ> &numbers, unsigned long effort,
+                                                     const SharedCallback &shared) {
+    auto divisors = BatchGCD().shared_divisors(numbers);
+    std::vector<Task> tasks(numbers.size());
+    /// All shared factors are reported before the first factorization is submitted to pool
+    for (std::size_t i = 0; i < numbers.size(); i++) {
+        if (divisors[i] > 1 && divisors[i] < numbers[i]) {
+            std::promise<NTL::ZZ> found;
+            found.set_value(divisors[i]);
+            tasks[i].result = found.get_future();
+            tasks[i].shared = true;
+            if (shared) {
+                shared(i, divisors[i]);
+            }
+        }
+    }
+    for (std::size_t i = 0; i < numbers.size(); i++) {
+        if (!tasks[i].shared) {
+            tasks[i] = factor(numbers[i], effort);
+        }
+    }
+    return tasks;
+}
+
+NTL::ZZ Factorizer::factor_parallel(const NTL::ZZ &n, const boost::mpi::environment &environment,
+                                    const boost::mpi::communicator &communicator, unsigned long effort) {
+    /// All ranks take same decisions, so they return together
+    auto options = _options_for(n);
+    if (n < 4 || NTL::ProbPrime(n)) {
+        return NTL::ZZ{0};
+    }
+    if ((n & 1) == 0) {
+        return communicator.rank() == 0 ? NTL::ZZ{2} : NTL::ZZ{0};
+    }
+    if (options->first_pass || options->pm1 || options->pp1) {
+        /// p-1 and p+1 are run only by master process
+        NTL::ZZ factor{0};
+        if (communicator.rank() == 0) {
+            if (options->pm1) {
+                factor = PollardPM1(options).factorize();
+            } else if (options->pp1) {
+                factor = WilliamsPP1(options).factorize();
+            } else {
+                factor = first_pass(options);
+            }
+        }
+        factor = _broadcast_factor(communicator, factor);
+        if (factor != 0 || options->pm1 || options->pp1) {
+            return communicator.rank() == 0 ? factor : NTL::ZZ{0};
+        }
+    }
+    if (QuadraticSieve::is_suitable(*options)) {
+        auto factor = _pretest_parallel(options, effort, environment, communicator);
+        /// Sieve is run only by master process, its threads are OpenMP threads of this process
+        if (factor == 0 && communicator.rank() == 0) {
+            QuadraticSieve qs(options);
+            qs.set_progress([&](const NTL::ZZ &relations) {
+                if (_progress) {
+                    _progress({n, NTL::ZZ{0}, relations, effort});
+                }
+                return true;
+            });
+            factor = qs.factorize();
+        }
+        factor = _broadcast_factor(communicator, factor);
+        if (factor != 0) {
+            return communicator.rank() == 0 ? factor : NTL::ZZ{0};
+        }
+    }
+
+    Lenstra ecm(options, make_model(options));
+    ecm.set_progress([&](const NTL::ZZ &curves) {
+        if (_progress) {
+            _progress({n, curves, NTL::ZZ{0}, effort});
+        }
+        return effort == 0 || curves < static_cast<long>(effort);
+    });
+    if (options->split_stage_two) {
+        return ecm.factorize_split(environment, communicator);
+    }
+    return ecm.factorize_parallel(environment, communicator);
+}
+
+NTL::ZZ Factorizer::_pretest_parallel(const std::shared_ptr<Options> &options, unsigned long effort,
+                                      const boost::mpi::environment &environment,
+                                      const boost::mpi::communicator &communicator) const {
+    /// Curves of level are counted on rank 0 for all ranks, so every level tries same number of curves as in _pretest
+    const auto &n = *options->composite_number;
+    const auto max_digits = static_cast<long>(PRETEST_RATIO * static_cast<double>(QuadraticSieve::digits(n)));
+    auto pretest = std::make_shared<Options>(*options);
+    pretest->bound = std::make_shared<NTL::ZZ>(0);
+    pretest->bound2 = std::make_shared<NTL::ZZ>(0);
+    for (const auto &level : EffortDatabase::LEVELS) {
+        if (level.digits > max_digits) {
+            break;
+        }
+        *pretest->bound = level.bound;
+        *pretest->bound2 = 100 * level.bound;
+        Lenstra ecm(pretest, make_model(pretest));
+        ecm.set_progress([&](const NTL::ZZ &curves) {
+            if (_progress) {
+                _progress({n, curves, NTL::ZZ{0}, effort});
+            }
+            return curves < static_cast<long>(level.curves) && (effort == 0 || curves < static_cast<long>(effort));
+        });
+        auto factor = _broadcast_factor(communicator, ecm.factorize_parallel(environment, communicator));
+        if (factor != 0) {
+            return factor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+NTL::ZZ Factorizer::_broadcast_factor(const boost::mpi::communicator &communicator, const NTL::ZZ &factor) {
+    std::string found;
+    if (communicator.rank() == 0) {
+        std::ostringstream buffer;
+        buffer << factor;
+        found = buffer.str();
+    }
+    boost::mpi::broadcast(communicator, found, 0);
+    NTL::ZZ result;
+    NTL::conv(result, found.c_str());
+    return result;
+}
+
+void Factorizer::set_progress_callback(Factorizer::ProgressCallback callback) {
+    _progress = std::move(callback);
+}
+
+std::shared_ptr<Options> Factorizer::_options_for(const NTL::ZZ &n) const {
+    auto options = std::make_shared<Options>(*_options);
+    options->composite_number = std::make_shared<NTL::ZZ>(n);
+    options->bound = std::make_shared<NTL::ZZ>(*_options->bound);
+    options->bound2 = std::make_shared<NTL::ZZ>(*_options->bound2);
+    options->weierstrass = !options->edwards && !options->hessian && !options->jacobi;
+    return options;
+}
+
+NTL::ZZ Factorizer::first_pass(const std::shared_ptr<Options> &options) {
+    /// Both methods cost about as much as one elliptic curve, so they are tried first
+    auto factor = PollardPM1(options).factorize();
+    if (factor == 0) {
+        factor = WilliamsPP1(options).factorize();
+    }
+    return factor;
+}
+
+NTL::ZZ Factorizer::_run(const std::shared_ptr<Options> &options, unsigned long effort,
+                         const std::atomic_bool &cancelled, const ProgressCallback &progress) {
+    /// Primes and too small numbers have no proper divisor
+    const auto &n = *options->composite_number;
+    if (n < 4 || NTL::ProbPrime(n)) {
+        return NTL::ZZ{0};
+    }
+    if ((n & 1) == 0) {
+        return NTL::ZZ{2};
+    }
+    if (options->effort_db.empty()) {
+        return _run_methods(options, effort, cancelled, progress, nullptr);
+    }
+    EffortDatabase database(options->effort_db);
+    auto known = database.find(n).factor_of(n);
+    if (known != 0) {
+        return known;
+    }
+    auto factor = _run_methods(options, effort, cancelled, progress, &database);
+    if (factor != 0) {
+        database.add_factor(n, factor);
+    }
+    return factor;
+}
+
+NTL::ZZ Factorizer::_run_methods(const std::shared_ptr<Options> &options, unsigned long effort,
+                                 const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                                 EffortDatabase *database) {
+    const auto &n = *options->composite_number;
+    const auto &bound = *options->bound, &bound2 = *options->bound2;
+    if (options->pm1) {
+        return _run_once(options, "pm1", bound, bound2, cancelled, database,
+                         [&]() { return PollardPM1(options).factorize(); });
+    }
+    if (options->pp1) {
+        return _run_once(options, "pp1", bound, bound2, cancelled, database,
+                         [&]() { return WilliamsPP1(options).factorize(); });
+    }
+    if (options->first_pass) {
+        auto factor = _run_once(options, "first-pass", bound, bound2, cancelled, database,
+                                [&]() { return first_pass(options); });
+        if (factor != 0) {
+            return factor;
+        }
+    }
+    if (QuadraticSieve::is_suitable(*options)) {
+        auto factor = _pretest(options, effort, cancelled, progress, database);
+        if (factor != 0 || cancelled.load()) {
+            return factor;
+        }
+        /// Sieve has no bounds, its parameters depend only on n
+        factor = _run_once(options, "qs", NTL::ZZ{0}, NTL::ZZ{0}, cancelled, database, [&]() {
+            QuadraticSieve qs(options);
+            qs.set_progress([&](const NTL::ZZ &relations) {
+                if (progress) {
+                    progress({n, NTL::ZZ{0}, relations, effort});
+                }
+                return !cancelled.load();
+            });
+            return qs.factorize();
+        });
+        /// ECM continues when sieve did not find nontrivial dependency
+        if (factor != 0 || cancelled.load()) {
+            return factor;
+        }
+    }
+
+    if (database) {
+        return _run_levels(options, effort, cancelled, progress, *database);
+    }
+    Lenstra ecm(options, make_model(options));
+    ecm.set_progress([&](const NTL::ZZ &curves) {
+        if (progress) {
+            progress({n, curves, NTL::ZZ{0}, effort});
+        }
+        return !cancelled.load() && (effort == 0 || curves < static_cast<long>(effort));
+    });
+    ecm.set_cancelled([&]() { return cancelled.load(); });
+    if (cancelled.load()) {
+        return NTL::ZZ{0};
+    }
+    return ecm.factorize();
+}
+
+NTL::ZZ Factorizer::_run_once(const std::shared_ptr<Options> &options, const std::string &method,
+                              const NTL::ZZ &bound, const NTL::ZZ &bound2,
+                              const std::atomic_bool &cancelled, EffortDatabase *database,
+                              const std::function<NTL::ZZ()> &run) {
+    if (!database) {
+        return run();
+    }
+    const auto &n = *options->composite_number;
+    const auto key = EffortDatabase::method_key(method, bound, bound2);
+    if (database->find(n).has_method(key)) {
+        return NTL::ZZ{0};
+    }
+    auto factor = run();
+    if (factor == 0 && !cancelled.load()) {
+        database->add_method(n, key);
+    }
+    return factor;
+}
+
+NTL::ZZ Factorizer::_pretest(const std::shared_ptr<Options> &options, unsigned long effort,
+                              const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                              EffortDatabase *database) {
+    /// Levels use their own bounds, bounds from command-line are left for ECM after sieve
+    const auto &n = *options->composite_number;
+    const auto max_digits = static_cast<long>(PRETEST_RATIO * static_cast<double>(QuadraticSieve::digits(n)));
+    auto pretest = std::make_shared<Options>(*options);
+    pretest->bound = std::make_shared<NTL::ZZ>(0);
+    pretest->bound2 = std::make_shared<NTL::ZZ>(0);
+    if (database) {
+        /// Curves are stored, so later levels continue where pretest stopped
+        return _run_levels(pretest, effort, cancelled, progress, *database, max_digits);
+    }
+    for (const auto &level : EffortDatabase::LEVELS) {
+        if (level.digits > max_digits || cancelled.load()) {
+            break;
+        }
+        *pretest->bound = level.bound;
+        *pretest->bound2 = 100 * level.bound;
+        Lenstra ecm(pretest, make_model(pretest));
+        ecm.set_progress([&](const NTL::ZZ &curves) {
+            if (progress) {
+                progress({n, curves, NTL::ZZ{0}, effort});
+            }
+            return !cancelled.load() && curves < static_cast<long>(level.curves) &&
+                   (effort == 0 || curves < static_cast<long>(effort));
+        });
+        ecm.set_cancelled([&]() { return cancelled.load(); });
+        auto factor = ecm.factorize();
+        if (factor != 0) {
+            return factor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+NTL::ZZ Factorizer::_run_levels(const std::shared_ptr<Options> &options, unsigned long effort,
+                                const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                                EffortDatabase &database, long max_digits) {
+    /// Bound from command-line is used for all curves, otherwise bounds grow as previous levels are finished
+    const auto &n = *options->composite_number;
+    const std::string model = options->model();
+    const bool fixed_bound = *options->bound > 0;
+    const bool fixed_bound2 = *options->bound2 > 0;
+    /// Tried curves are stored periodically, so they are not lost when process is killed
+    const auto save_interval = std::chrono::seconds(5);
+    NTL::ZZ total(0);
+    while (!cancelled.load() && (effort == 0 || total < static_cast<long>(effort))) {
+        auto record = database.find(n);
+        auto level = EffortDatabase::next_level(record, model);
+        if (max_digits > 0 && (fixed_bound || level.second == 0 || level.first.digits > max_digits)) {
+            break;
+        }
+        if (fixed_bound) {
+            level.second = 0;
+        } else {
+            *options->bound = level.first.bound;
+            if (!fixed_bound2) {
+                *options->bound2 = 100 * level.first.bound;
+            }
+        }
+        const auto bound = NTL::conv<long>(*options->bound);
+
+        /// Fresh seed gives curves different from all previous runs
+        auto seed = EffortDatabase::fresh_seed(record);
+        database.add_seed(n, seed);
+        NTL::SetSeed(NTL::conv<NTL::ZZ>(seed));
+
+        Lenstra ecm(options, make_model(options));
+        NTL::ZZ tried(0);
+        long saved = 0;
+        auto last_save = std::chrono::steady_clock::now();
+        ecm.set_progress([&](const NTL::ZZ &curves) {
+            tried = curves;
+            if (progress) {
+                progress({n, total + curves, NTL::ZZ{0}, effort});
+            }
+            if (std::chrono::steady_clock::now() - last_save >= save_interval) {
+                database.add_curves(n, model, bound, NTL::conv<long>(curves) - saved);
+                saved = NTL::conv<long>(curves);
+                last_save = std::chrono::steady_clock::now();
+            }
+            return !cancelled.load() && (effort == 0 || total + curves < static_cast<long>(effort)) &&
+                   (level.second == 0 || curves < static_cast<long>(level.second));
+        });
+        ecm.set_cancelled([&]() { return cancelled.load(); });
+        auto factor = ecm.factorize();
+        database.add_curves(n, model, bound, NTL::conv<long>(tried) - saved);
+        total += tried;
+        if (factor != 0) {
+            return factor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+std::shared_ptr<AbstractModel> Factorizer::make_model(const std::shared_ptr<Options> &options) {
+    if (options->hessian) {
+        return std::make_shared<HessianModel>(options);
+    }
+    if (options->jacobi) {
+        return std::make_shared<JacobiIntersectionModel>(options);
+    }
+    if (options->edwards) {
+        return std::make_shared<EdwardsModel>(options);
+    }
+    return std::make_shared<WeierstrassModel>(options);
+}
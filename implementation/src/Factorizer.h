@@ -0,0 +1,149 @@
+#ifndef DIP_FACTORIZER_H
+#define DIP_FACTORIZER_H
+
+#include <NTL/ZZ.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/mpi/communicator.hpp>
+#include <boost/mpi/environment.hpp>
+
+#include "AbstractModel.h"
+#include "EffortDatabase.h"
+#include "Options.h"
+#include "ThreadPool.h"
+
+struct FactorizationProgress {
+    /// This struct describes state of running factorization reported to progress callback
+    NTL::ZZ composite_number;
+    /// Number of elliptic curves already tried
+    NTL::ZZ curves;
+    /// Number of relations collected by quadratic sieve
+    NTL::ZZ relations;
+    /// Maximal number of curves for this factorization (0 means unlimited)
+    unsigned long effort = 0;
+};
+
+class Factorizer final {
+    /// Reentrant entry point of library. Every factorization owns its own options, model and state,
+    /// so one factorizer can run many factorizations at the same time.
+public:
+    using ProgressCallback = std::function<void(const FactorizationProgress &)>;
+    /// Called with index of number and its divisor shared with other numbers
+    using SharedCallback = std::function<void(std::size_t, const NTL::ZZ &)>;
+
+    class Task final {
+        /// Handle of running factorization. Result is 0 when no factor was found or task was cancelled.
+    public:
+        std::future<NTL::ZZ> result;
+        /// Result is divisor shared with other numbers found by batch GCD, no factorization was started
+        bool shared = false;
+
+        /// This function asks running factorization to stop as soon as possible
+        void cancel() noexcept;
+
+    private:
+        friend class Factorizer;
+
+        std::shared_ptr<std::atomic_bool> _cancelled = std::make_shared<std::atomic_bool>(false);
+    };
+
+    /// Options are used as template for every factorization, composite number in them is ignored.
+    /// When pool is not given, factorizer creates its own pool with one worker.
+    explicit Factorizer(std::shared_ptr<Options> options, std::shared_ptr<ThreadPool> pool = nullptr);
+
+    Factorizer(const Factorizer &) = delete;
+    Factorizer &operator=(const Factorizer &) = delete;
+
+    /// Destructor cancels all tasks started by this factorizer
+    ~Factorizer();
+
+    /// This function starts factorization of n on thread pool and returns immediately.
+    /// Parallel parts of factorization use at most processors / pool size OpenMP threads.
+    /// Effort is maximal number of elliptic curves to try (0 means unlimited).
+    [[nodiscard]] Task factor(const NTL::ZZ &n, unsigned long effort = 0);
+
+    /// This function finds factors shared between numbers by batch GCD in calling thread first, then it starts
+    /// factorization of numbers without shared factor. Tasks are in order of numbers.
+    /// Callback is called in calling thread for every shared factor before any factorization is started.
+    [[nodiscard]] std::vector<Task> factor_all(const std::vector<NTL::ZZ> &numbers, unsigned long effort = 0,
+                                               const SharedCallback &shared = nullptr);
+
+    /// This function factorizes n by all ranks of communicator in calling thread. p-1, p+1 and quadratic sieve
+    /// are run only by rank 0 (other ranks wait for them), ECM pretest before sieve and ECM are run by all ranks
+    /// (with split stage 2 when options say so).
+    /// Callback is called on rank 0 with number of generated curves, effort limits them.
+    /// Returns factor on rank 0 and 0 on other ranks, all ranks return together. MPI environment is owned by caller.
+    [[nodiscard]] NTL::ZZ factor_parallel(const NTL::ZZ &n, const boost::mpi::environment &environment,
+                                          const boost::mpi::communicator &communicator, unsigned long effort = 0);
+
+    /// This function sets callback which is called from working thread after every tried curve
+    void set_progress_callback(ProgressCallback callback);
+
+    /// This function runs p-1 and p+1 methods in calling thread and returns found factor or 0
+    [[nodiscard]] static NTL::ZZ first_pass(const std::shared_ptr<Options> &options);
+
+    /// Creates curve model selected by options
+    [[nodiscard]] static std::shared_ptr<AbstractModel> make_model(const std::shared_ptr<Options> &options);
+
+private:
+    /// ECM before quadratic sieve looks for factors with at most this fraction of digits of composite number
+    static constexpr double PRETEST_RATIO = 0.3;
+
+    std::shared_ptr<Options> _options;
+    std::shared_ptr<ThreadPool> _pool;
+    ProgressCallback _progress;
+
+    /// Cancel flags of started tasks
+    std::vector<std::weak_ptr<std::atomic_bool>> _tasks;
+    std::mutex _mutex;
+
+    /// Creates deep copy of options for composite number n
+    [[nodiscard]] std::shared_ptr<Options> _options_for(const NTL::ZZ &n) const;
+
+    /// Runs whole factorization of number in options in calling thread, known factors are taken from effort database
+    [[nodiscard]] static NTL::ZZ _run(const std::shared_ptr<Options> &options, unsigned long effort,
+                                      const std::atomic_bool &cancelled, const ProgressCallback &progress);
+
+    /// Runs methods selected by options in calling thread
+    [[nodiscard]] static NTL::ZZ _run_methods(const std::shared_ptr<Options> &options, unsigned long effort,
+                                              const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                                              EffortDatabase *database);
+
+    /// Runs method unless effort database says that its run with same bounds finished without factor.
+    /// Finished run without factor is stored, cancelled run is not.
+    [[nodiscard]] static NTL::ZZ _run_once(const std::shared_ptr<Options> &options, const std::string &method,
+                                           const NTL::ZZ &bound, const NTL::ZZ &bound2,
+                                           const std::atomic_bool &cancelled, EffortDatabase *database,
+                                           const std::function<NTL::ZZ()> &run);
+
+    /// Runs ECM on levels of effort database for factors up to PRETEST_RATIO of digits, so small factors
+    /// are not left to quadratic sieve whose running time depends only on size of composite number
+    [[nodiscard]] static NTL::ZZ _pretest(const std::shared_ptr<Options> &options, unsigned long effort,
+                                          const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                                          EffortDatabase *database);
+
+    /// Runs ECM pretest levels like _pretest, curves of every level are spread across all ranks of communicator.
+    /// Returns found factor on all ranks.
+    [[nodiscard]] NTL::ZZ _pretest_parallel(const std::shared_ptr<Options> &options, unsigned long effort,
+                                            const boost::mpi::environment &environment,
+                                            const boost::mpi::communicator &communicator) const;
+
+    /// Sends factor of rank 0 to all ranks
+    [[nodiscard]] static NTL::ZZ _broadcast_factor(const boost::mpi::communicator &communicator,
+                                                   const NTL::ZZ &factor);
+
+    /// Runs ECM with fresh seeds on levels of stage 1 bound not finished by previous runs, tried curves are stored.
+    /// Levels for factors with more than max_digits digits are not run (0 means no limit).
+    [[nodiscard]] static NTL::ZZ _run_levels(const std::shared_ptr<Options> &options, unsigned long effort,
+                                             const std::atomic_bool &cancelled, const ProgressCallback &progress,
+                                             EffortDatabase &database, long max_digits = 0);
+};
+
+
+#endif //DIP_FACTORIZER_H
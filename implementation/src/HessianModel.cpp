@@ -0,0 +1,94 @@
+#include "HessianModel.h"
+#include "Trace.h"
+
+ProjectivePoint HessianModel::add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const {
+    /// Rotated addition formulas for twisted Hessian curves (Bernstein, Kohel, Lange), 12M
+    if (is_infinity_point(P)) {
+        return Q;
+    }
+
+    if (is_infinity_point(Q)) {
+        return P;
+    }
+
+    NTL::ZZ A = _mul(P.x, Q.z);
+    NTL::ZZ B = _mul(P.z, Q.z);
+    NTL::ZZ C = _mul(P.y, Q.x);
+    NTL::ZZ D = _mul(P.y, Q.y);
+    NTL::ZZ E = _mul(P.z, Q.y);
+    NTL::ZZ F = _mul(_reduce(_ecc.a * P.x), Q.x);
+
+    return {
+            _reduce(A * B - C * D),
+            _reduce(D * E - F * A),
+            _reduce(F * C - B * E)
+    };
+}
+
+ProjectivePoint HessianModel::double_point(const ProjectivePoint &P) const {
+    /// Doubling formulas for twisted Hessian curves, X3 = X(Z^3 - Y^3), Y3 = Z(Y^3 - aX^3), Z3 = Y(aX^3 - Z^3)
+    if (is_infinity_point(P)) {
+        return P;
+    }
+
+    NTL::ZZ X3 = _reduce(_mul(_ecc.a, _reduce(P.x * P.x)) * P.x);
+    NTL::ZZ Y3 = _reduce(_reduce(P.y * P.y) * P.y);
+    NTL::ZZ Z3 = _reduce(_reduce(P.z * P.z) * P.z);
+
+    return {
+            _reduce(P.x * (Z3 - Y3)),
+            _reduce(P.z * (Y3 - X3)),
+            _reduce(P.y * (X3 - Z3))
+    };
+}
+
+ProjectivePoint HessianModel::generate_elliptic_curve() {
+    TRACE_SPAN(_options->tracer, "generate curve");
+    ProjectivePoint ret;
+    ret.z = 1;
+    _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
+    const auto &n = *_ecc.modulus;
+    /// Random point (x, y) and a determine d = (ax^3 + y^3 + 1) / xy, curve is singular when a(27a - d^3) = 0
+    while (true) {
+        ret.x = NTL::RandomBnd(n);
+        ret.y = NTL::RandomBnd(n);
+        _ecc.a = NTL::RandomBnd(n);
+        auto xy = NTL::MulMod(ret.x, ret.y, n);
+        if (NTL::GCD(xy, n) != 1) {
+            continue;
+        }
+        auto numerator = (_ecc.a * NTL::PowerMod(ret.x, 3, n) + NTL::PowerMod(ret.y, 3, n) + 1) % n;
+        _ecc.d = NTL::MulMod(numerator, NTL::InvMod(xy, n), n);
+        if (NTL::GCD(_ecc.a * (_ecc.a * 27 - NTL::PowerMod(_ecc.d, 3, n)), n) != 1) {
+            continue;
+        }
+        /// Duplicate check
+        if (_duplicates.find(_ecc) == _duplicates.end()) {
+            break;
+        }
+    }
+
+    _duplicates.insert(_ecc);
+
+    return ret;
+}
+
+bool HessianModel::is_infinity_point(const ProjectivePoint &point) const noexcept {
+    return NTL::IsZero(point.x) && !NTL::IsZero(point.z) && NTL::IsZero((point.y + point.z) % *_options->composite_number);
+}
+
+NTL::ZZ HessianModel::try_get_factor(const ProjectivePoint &point) const noexcept {
+    return NTL::GCD(point.x, *_options->composite_number);
+}
+
+HessianModel::EllipticCurve HessianModel::get_elliptic_curve() const noexcept {
+    return _ecc;
+}
+
+void HessianModel::set_elliptic_curve(const HessianModel::EllipticCurve &curve) {
+    _ecc = curve;
+    /// Modulus is set only to composite number value from command-line
+    _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
+}
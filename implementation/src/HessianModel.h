@@ -0,0 +1,78 @@
+#ifndef DIP_HESSIANMODEL_H
+#define DIP_HESSIANMODEL_H
+
+#include "AbstractModel.h"
+
+#include <set>
+
+class HessianModel final : public AbstractModel {
+public:
+
+    struct EllipticCurve {
+        /// This struct represents twisted Hessian curve aX^3 + Y^3 + Z^3 = dXYZ
+        NTL::ZZ a;
+        NTL::ZZ d;
+
+        std::shared_ptr<NTL::ZZ> modulus = nullptr;
+
+        /// Number of values in binary format
+        static constexpr long WIRE_VALUES = 2;
+        /// Writes curve parameters in binary format and returns end of written data
+        unsigned char *to_bytes(unsigned char *buffer, long slot) const {
+            return wire::write(buffer, slot, {&a, &d});
+        }
+        /// Reads curve parameters in binary format and returns end of read data
+        const unsigned char *from_bytes(const unsigned char *buffer, long slot) {
+            return wire::read(buffer, slot, {&a, &d});
+        }
+
+        /// Auxiliary function for std::set, which requires this operator
+        bool operator<(const EllipticCurve &rhs) const {
+            return a < rhs.a || (a == rhs.a && d < rhs.d);
+        }
+    };
+
+    /// Neutral point is (0 : -1 : 1)
+    explicit HessianModel(std::shared_ptr<Options> options) : AbstractModel(std::move(options), {
+                                                                      NTL::conv<NTL::ZZ>(0),
+                                                                      NTL::conv<NTL::ZZ>(-1),
+                                                                      NTL::conv<NTL::ZZ>(1)})
+    {}
+    /// This function implements rotated addition on twisted Hessian curve, it works also for doubling
+    [[nodiscard]] ProjectivePoint add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const override;
+
+    /// This function implements doubling point on twisted Hessian curve
+    [[nodiscard]] ProjectivePoint double_point(const ProjectivePoint &P) const override;
+
+    /// This function implements generation of new elliptic curve and returns point on this curve
+    ProjectivePoint generate_elliptic_curve() override;
+
+    /// Point is neutral when X = 0 and Y = -Z
+    [[nodiscard]] bool is_infinity_point(const ProjectivePoint &point) const noexcept override;
+
+    /// X coordinate of multiple of point is divisible by factor, when point is neutral modulo this factor
+    [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override;
+
+    [[nodiscard]] const NTL::ZZ &factor_coordinate(const ProjectivePoint &point) const noexcept override {
+        return point.x;
+    }
+
+    [[nodiscard]] bool sticky_factor_coordinate() const noexcept override {
+        return true;
+    }
+
+    /// This function gets new elliptic curve
+    [[nodiscard]] EllipticCurve get_elliptic_curve() const noexcept;
+
+    /// This function sets new elliptic curve
+    void set_elliptic_curve(const EllipticCurve &curve);
+
+private:
+
+    EllipticCurve _ecc;
+
+    std::set<EllipticCurve> _duplicates;
+};
+
+
+#endif //DIP_HESSIANMODEL_H
@@ -0,0 +1,104 @@
+#include "JacobiIntersectionModel.h"
+#include "Trace.h"
+
+ProjectivePoint JacobiIntersectionModel::add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const {
+    /// Unified addition formulas for Jacobi intersection (Hisil, Wong, Carter, Dawson)
+    if (is_infinity_point(P)) {
+        return Q;
+    }
+
+    if (is_infinity_point(Q)) {
+        return P;
+    }
+
+    NTL::ZZ SC = _reduce(P.x * Q.y);
+    NTL::ZZ CS = _reduce(P.y * Q.x);
+    NTL::ZZ SS = _reduce(P.x * Q.x);
+    NTL::ZZ CC = _reduce(P.y * Q.y);
+    NTL::ZZ DD = _reduce(P.t * Q.t);
+    NTL::ZZ ZZ2 = _reduce(P.z * Q.z);
+    NTL::ZZ aSS = _reduce(_ecc.a * SS);
+
+    ProjectivePoint R;
+    R.x = _reduce(SC * _reduce(Q.t * P.z) + CS * _reduce(P.t * Q.z));
+    R.y = _reduce(CC * ZZ2 - SS * DD);
+    R.t = _reduce(DD * ZZ2 - aSS * CC);
+    R.z = _reduce(ZZ2 * ZZ2 - aSS * SS);
+    return R;
+}
+
+ProjectivePoint JacobiIntersectionModel::double_point(const ProjectivePoint &P) const {
+    /// Doubling formulas S3 = 2SCDZ, C3 = C^2Z^2 - S^2D^2, D3 = D^2Z^2 - aS^2C^2, Z3 = Z^4 - aS^4
+    if (is_infinity_point(P)) {
+        return P;
+    }
+
+    NTL::ZZ S2 = _reduce(P.x * P.x);
+    NTL::ZZ C2 = _reduce(P.y * P.y);
+    NTL::ZZ D2 = _reduce(P.t * P.t);
+    NTL::ZZ Z2 = _reduce(P.z * P.z);
+    NTL::ZZ aS2 = _reduce(_ecc.a * S2);
+
+    ProjectivePoint R;
+    R.x = _reduce(_reduce(P.x * P.y) * _reduce(P.t * P.z) << 1);
+    R.y = _reduce(C2 * Z2 - S2 * D2);
+    R.t = _reduce(D2 * Z2 - aS2 * C2);
+    R.z = _reduce(Z2 * Z2 - aS2 * S2);
+    return R;
+}
+
+ProjectivePoint JacobiIntersectionModel::generate_elliptic_curve() {
+    TRACE_SPAN(_options->tracer, "generate curve");
+    ProjectivePoint ret;
+    _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
+    const auto &n = *_ecc.modulus;
+    /// Point on circle S^2 + C^2 = 1 is S = 2u / (1 + u^2), C = (1 - u^2) / (1 + u^2),
+    /// random D determines a = (1 - D^2) / S^2, curve is singular when a(1 - a) = 0
+    while (true) {
+        auto u = NTL::RandomBnd(n);
+        auto u2 = NTL::MulMod(u, u, n);
+        auto denominator = (u2 + 1) % n;
+        auto s = (u << 1) % n;
+        if (NTL::GCD(denominator, n) != 1 || NTL::GCD(s, n) != 1) {
+            continue;
+        }
+        auto inverse = NTL::InvMod(denominator, n);
+        ret.x = NTL::MulMod(s, inverse, n);
+        ret.y = NTL::MulMod((1 - u2) % n, inverse, n);
+        ret.t = NTL::RandomBnd(n);
+        ret.z = 1;
+        auto s2 = NTL::MulMod(ret.x, ret.x, n);
+        _ecc.a = NTL::MulMod((1 - NTL::MulMod(ret.t, ret.t, n)) % n, NTL::InvMod(s2, n), n);
+        if (NTL::GCD(_ecc.a * (1 - _ecc.a), n) != 1) {
+            continue;
+        }
+        /// Duplicate check
+        if (_duplicates.find(_ecc) == _duplicates.end()) {
+            break;
+        }
+    }
+
+    _duplicates.insert(_ecc);
+
+    return ret;
+}
+
+bool JacobiIntersectionModel::is_infinity_point(const ProjectivePoint &point) const noexcept {
+    return NTL::IsZero(point.x) && !NTL::IsZero(point.z) && point.y == point.z && point.t == point.z;
+}
+
+NTL::ZZ JacobiIntersectionModel::try_get_factor(const ProjectivePoint &point) const noexcept {
+    return NTL::GCD(point.x, *_options->composite_number);
+}
+
+JacobiIntersectionModel::EllipticCurve JacobiIntersectionModel::get_elliptic_curve() const noexcept {
+    return _ecc;
+}
+
+void JacobiIntersectionModel::set_elliptic_curve(const JacobiIntersectionModel::EllipticCurve &curve) {
+    _ecc = curve;
+    /// Modulus is set only to composite number value from command-line
+    _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
+}
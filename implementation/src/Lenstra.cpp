@@ -1,53 +1,158 @@
 #include "Lenstra.h"
-#include <iostream>
+#include "Stages.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <boost/mpi.hpp>
 #include <omp.h>
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
 
 namespace mpi = boost::mpi;
 
-NTL::ZZ generated_counter{0};
-int end = 0;
-
 NTL::ZZ Lenstra::factorize() const {
     /// Sequential algorithm for computing factorization
     auto divisor = NTL::conv<NTL::ZZ>(1);
     auto sqrt_n = NTL::SqrRoot(*_options->composite_number);
 
-    NTL::ZZ bound = sqrt_n;
-    if (*_options->bound > 2)
-        bound = (*_options->bound < sqrt_n ? *_options->bound : sqrt_n);
-    auto divided = bound / 1000000;
-    NTL::ZZ test_after{(divided < 100 ? (NTL::ZZ)100 : divided)};
-    NTL::ZZ counter(1);
+    Bounds bounds(*_options, sqrt_n);
+    NTL::ZZ curves(0);
     while (true) {
         auto point = _model->generate_elliptic_curve();
-        for (NTL::ZZ k{2}; k < bound; k++, counter++) {
-            point = _model->mul_points(k, point);
-            if (counter % test_after == 0) {
-                divisor = _model->try_get_factor(point);
-                if (divisor > 1 && divisor < *_options->composite_number) {
-                    return divisor;
-                }
-                counter = 0;
+        divisor = _stage_one(bounds, point);
+        if (divisor == 0 || (divisor > 1 && divisor < *_options->composite_number)) {
+            return divisor;
+        }
+        if (divisor == 1 && !_model->is_infinity_point(point)) {
+            divisor = _stage_two(bounds, point);
+            if (divisor > 1 && divisor < *_options->composite_number) {
+                return divisor;
             }
-            if (_model->is_infinity_point(point)) {
-                break;
+        }
+        curves++;
+        if (_progress && !_progress(curves)) {
+            return NTL::ZZ{0};
+        }
+    }
+}
+
+NTL::ZZ Lenstra::_stage_one(const Bounds &bounds, ProjectivePoint &point) const {
+    /// Multiplies point by all stage 1 scalars, GCD is computed only at the end of every phase
+    TRACE_SPAN(_options->tracer, "stage 1");
+    Phase phase;
+    phase.started = Trace::start(_options->tracer);
+    PrimePowers scalars(bounds.stage_one);
+    for (NTL::ZZ scalar; scalars.next(scalar);) {
+        _multiply(phase, scalar, point);
+        if (_model->is_infinity_point(point)) {
+            break;
+        }
+        if (phase.scalars.size() >= PHASE_LENGTH) {
+            auto divisor = _finish_phase(phase);
+            if (divisor != 1) {
+                return divisor;
             }
         }
-        divisor = _model->try_get_factor(point);
-        if (divisor > 1 && divisor < *_options->composite_number) {
-            return divisor;
+    }
+    return _finish_phase(phase);
+}
+
+void Lenstra::_multiply(Lenstra::Phase &phase, const NTL::ZZ &scalar, ProjectivePoint &point) const {
+    /// Point is saved before every CHECKPOINT_INTERVAL-th scalar, coordinate of result goes to accumulator
+    if (phase.scalars.size() % CHECKPOINT_INTERVAL == 0) {
+        phase.checkpoints.push_back(point);
+    }
+    phase.scalars.push_back(scalar);
+    point = _model->mul_points(scalar, point);
+    phase.accumulator = _model->mul_mod(phase.accumulator, _model->factor_coordinate(point));
+}
+
+NTL::ZZ Lenstra::_finish_phase(Lenstra::Phase &phase) const {
+    /// One GCD for whole phase, when it is N more factors were found at once and phase is replayed
+    TRACE_SPAN_SINCE(_options->tracer, "phase", phase.started);
+    TRACE_SPAN(_options->tracer, "gcd");
+    auto divisor = NTL::GCD(phase.accumulator, *_options->composite_number);
+    if (divisor == *_options->composite_number) {
+        divisor = _backtrack(phase);
+    }
+    if (divisor == 1 && _cancelled && _cancelled()) {
+        divisor = 0;
+    }
+    phase.scalars.clear();
+    phase.checkpoints.clear();
+    phase.accumulator = 1;
+    phase.started = Trace::start(_options->tracer);
+    return divisor;
+}
+
+NTL::ZZ Lenstra::_backtrack(const Lenstra::Phase &phase) const {
+    /// Segments are replayed with GCD after every scalar. When coordinate of model stays divisible by factor once
+    /// point is neutral modulo this factor, segments which end with coordinate coprime to N are skipped.
+    TRACE_SPAN(_options->tracer, "backtrack");
+    const auto &n = *_options->composite_number;
+    const bool sticky = _model->sticky_factor_coordinate();
+    for (std::size_t checkpoint = 0; checkpoint < phase.checkpoints.size(); checkpoint++) {
+        if (sticky && checkpoint + 1 < phase.checkpoints.size() &&
+            NTL::GCD(_model->factor_coordinate(phase.checkpoints[checkpoint + 1]), n) == 1) {
+            continue;
+        }
+        auto point = phase.checkpoints[checkpoint];
+        auto end = std::min(phase.scalars.size(), (checkpoint + 1) * CHECKPOINT_INTERVAL);
+        for (auto i = checkpoint * CHECKPOINT_INTERVAL; i < end; i++) {
+            point = _model->mul_points(phase.scalars[i], point);
+            auto divisor = NTL::GCD(_model->factor_coordinate(point), n);
+            if (divisor != 1) {
+                return divisor;
+            }
         }
     }
+    return n;
+}
+
+NTL::ZZ Lenstra::_stage_two(const Bounds &bounds, const ProjectivePoint &point) const {
+    /// Blocks are processed by OpenMP threads, one GCD for product of all blocks
+    TRACE_SPAN(_options->tracer, "stage 2");
+    return NTL::GCD(_stage_two_blocks(bounds, point, 0, 1), *_options->composite_number);
 }
 
-NTL::ZZ Lenstra::factorize_parallel(int argc, char **argv) {
+NTL::ZZ Lenstra::_stage_two_blocks(const Bounds &bounds, const ProjectivePoint &point, long first, long stride) const {
+    /// Every block has its own accumulator, accumulators are multiplied at the end
+    const auto &n = *_options->composite_number;
+    const long blocks = bounds.stage_two_blocks();
+    NTL::ZZ product{1};
+    #pragma omp parallel for schedule(dynamic) shared(product)
+    for (long block = first; block < blocks; block += stride) {
+        auto accumulator = _stage_two_block(bounds, point, block);
+        #pragma omp critical (stage_two)
+        {
+            product = NTL::MulMod(product, accumulator, n);
+        }
+    }
+    return product;
+}
+
+NTL::ZZ Lenstra::_stage_two_block(const Bounds &bounds, const ProjectivePoint &point, long block) const {
+    /// Computes q * point for primes q in block, multiples of point by gaps between primes are cached
+    TRACE_SPAN(_options->tracer, "stage 2 block");
+    auto range = bounds.stage_two_block(block);
+    StageTwoPrimes primes(range.first, range.second);
+    std::map<long, ProjectivePoint> gaps;
+    ProjectivePoint current;
+    return stage_two_product(primes, *_options->composite_number, [&](long prime) {
+        current = _model->mul_points(NTL::ZZ(prime), point);
+        return _model->factor_coordinate(current);
+    }, [&](long gap) {
+        auto cached = gaps.find(gap);
+        if (cached == gaps.end()) {
+            cached = gaps.emplace(gap, _model->mul_points(NTL::ZZ(gap), point)).first;
+        }
+        current = _model->add_points(current, cached->second);
+        return _model->factor_coordinate(current);
+    });
+}
+
+NTL::ZZ Lenstra::factorize_parallel(const mpi::environment &env, const mpi::communicator &world) {
     /// Master-slave algorithm
-    /// First we initialize communication environment via mpi::environment and mpi::communicator
-    mpi::environment env(argc, argv, mpi::threading::multiple);
-    mpi::communicator world;
 
     /// Result of factorizing
     NTL::ZZ result{0};
@@ -58,29 +163,143 @@ NTL::ZZ Lenstra::factorize_parallel(int argc, char **argv) {
         _point = _model->generate_elliptic_curve();
     } else {
         /// slave part
-        _get_ecc(env, world);
+        _end = !_get_ecc(env, world);
     }
 
-    mpi::timer timer;
-
     result = _factorize_parallel(env, world);
+    _finish_parallel(env, world);
+
+    /// Factors found by any ranks are gathered to rank 0, it returns the first one
+    std::ostringstream buffer;
+    buffer << result;
+    std::vector<std::string> results;
+    {
+        TRACE_SPAN(_options->tracer, "mpi gather");
+        mpi::gather(world, buffer.str(), results, 0);
+    }
+    result = 0;
+    for (const auto &found : results) {
+        NTL::conv(result, found.c_str());
+        if (result != 0) {
+            break;
+        }
+    }
+    return result;
+}
 
-    double elapsed = timer.elapsed();
-
-    if (result != 0) {
-        std::cout << "proc " << world.rank() << ": factor = " << result << "\n";
-        std::cout << "proc " << world.rank() << ": time = " << elapsed << " s\n";
-        _stop_all(env, world);
-        mpi::environment::abort(0);
+NTL::ZZ Lenstra::factorize_split(const mpi::environment &env, const mpi::communicator &world) {
+    /// Every rank runs stage 1 of its own curve. Stage 2 of every curve which survived stage 1 is processed by all
+    /// ranks at once, every rank takes every size-th block and accumulators are gathered to owner of curve for one GCD.
+    const auto &n = *_options->composite_number;
+    Bounds bounds(*_options, NTL::SqrRoot(n));
+    if (!bounds.has_stage_two()) {
+        throw std::invalid_argument("Split stage 2 requires bound2 bigger than bound");
     }
+    /// Ranks start with same random generator, so every rank draws its curves from its own seed
+    NTL::SetSeed(NTL::RandomBnd(NTL::ZZ(1L << 62)) * world.size() + world.rank());
+
+    const auto slot = NTL::NumBytes(n);
+    std::vector<unsigned char> accumulator(slot), accumulators(slot * world.size()), own;
+    std::vector<int> states;
+    NTL::ZZ divisor{0};
+    NTL::ZZ curves{0};
+    while (true) {
+        _point = _model->generate_elliptic_curve();
+        divisor = _stage_one(bounds, _point);
+        int state = SPLIT::STAGE_TWO;
+        if (divisor > 1 && divisor < n) {
+            state = SPLIT::FOUND;
+        } else if (divisor != 1 || _model->is_infinity_point(_point)) {
+            state = SPLIT::NEXT_CURVE;
+        } else {
+            /// Curve of this rank is replaced by curves of other ranks before its stage 2
+            _store_curve();
+            own = _wire;
+        }
+        {
+            TRACE_SPAN(_options->tracer, "mpi all gather");
+            mpi::all_gather(world, state, states);
+        }
 
-    world.barrier();
+        int found = static_cast<int>(std::find(states.begin(), states.end(), SPLIT::FOUND) - states.begin());
+        for (int owner = 0; owner < world.size() && found == world.size(); owner++) {
+            if (states[owner] != SPLIT::STAGE_TWO) {
+                continue;
+            }
+            if (world.rank() == owner) {
+                _wire = own;
+            }
+            _broadcast_curve(world, owner);
+            NTL::BytesFromZZ(accumulator.data(), _stage_two_blocks(bounds, _point, world.rank(), world.size()), slot);
+            {
+                TRACE_SPAN(_options->tracer, "mpi gather");
+                mpi::gather(world, accumulator.data(), static_cast<int>(slot), accumulators.data(), owner);
+            }
+            if (world.rank() == owner) {
+                NTL::ZZ product{1}, value;
+                for (int rank = 0; rank < world.size(); rank++) {
+                    NTL::ZZFromBytes(value, accumulators.data() + rank * slot, slot);
+                    product = NTL::MulMod(product, value, n);
+                }
+                divisor = NTL::GCD(product, n);
+                state = divisor > 1 && divisor < n ? SPLIT::FOUND : SPLIT::NEXT_CURVE;
+            }
+            {
+                TRACE_SPAN(_options->tracer, "mpi broadcast");
+                mpi::broadcast(world, state, owner);
+            }
+            if (state == SPLIT::FOUND) {
+                found = owner;
+            }
+        }
 
-    if (world.rank() == 0) {
-        std::cout << "generated ecc = " << generated_counter << "\n";
+        if (found < world.size()) {
+            /// Factor is sent from rank which found it
+            NTL::BytesFromZZ(accumulator.data(), world.rank() == found ? divisor : NTL::ZZ{0}, slot);
+            {
+                TRACE_SPAN(_options->tracer, "mpi broadcast");
+                mpi::broadcast(world, accumulator.data(), static_cast<int>(slot), found);
+            }
+            NTL::ZZFromBytes(divisor, accumulator.data(), slot);
+            return world.rank() == 0 ? divisor : NTL::ZZ{0};
+        }
+        int stopped = 0;
+        if (world.rank() == 0) {
+            curves += world.size();
+            stopped = (_progress && !_progress(curves)) || (_cancelled && _cancelled());
+        }
+        {
+            TRACE_SPAN(_options->tracer, "mpi broadcast");
+            mpi::broadcast(world, stopped, 0);
+        }
+        if (stopped) {
+            return NTL::ZZ{0};
+        }
+    }
+}
+
+void Lenstra::_store_curve() {
+    if (_options->weierstrass) {
+        _store_curve<WeierstrassModel>();
+    } else if (_options->hessian) {
+        _store_curve<HessianModel>();
+    } else if (_options->jacobi) {
+        _store_curve<JacobiIntersectionModel>();
+    } else {
+        _store_curve<EdwardsModel>();
     }
+}
 
-    return result;
+void Lenstra::_broadcast_curve(const mpi::communicator &communicator, int root) {
+    if (_options->weierstrass) {
+        _broadcast_curve<WeierstrassModel>(communicator, root);
+    } else if (_options->hessian) {
+        _broadcast_curve<HessianModel>(communicator, root);
+    } else if (_options->jacobi) {
+        _broadcast_curve<JacobiIntersectionModel>(communicator, root);
+    } else {
+        _broadcast_curve<EdwardsModel>(communicator, root);
+    }
 }
 
 void Lenstra::_generate_ecc(const mpi::environment &environment, const mpi::communicator &communicator) {
@@ -94,58 +313,81 @@ NTL::ZZ Lenstra::_factorize_parallel(const mpi::environment &environment, const
     /// starts computing algorithm for process
     std::vector<ProjectivePoint> points;
     NTL::ZZ result{0};
-    NTL::ZZ k{1};
-    NTL::ZZ counter{1};
     auto divisor = NTL::conv<NTL::ZZ>(1);
     auto sqrt_n = NTL::SqrRoot(*_options->composite_number);
 
-    NTL::ZZ bound = sqrt_n;
-    if (*_options->bound > 2)
-        bound = (*_options->bound < sqrt_n ? *_options->bound : sqrt_n);
-    auto divided = bound / 1000000;
-    NTL::ZZ test_after{(divided < 100 ? (NTL::ZZ)100 : divided)};
+    Bounds bounds(*_options, sqrt_n);
 
-    while(!end) {
-        k = 2;
+    while(!_end) {
+        /// Stage 1 scalars are shared by all threads
+        PrimePowers scalars(bounds.stage_one);
         points.clear();
-        #pragma omp parallel shared(points, result, end, k, environment, communicator, sqrt_n, test_after)
+        #pragma omp parallel shared(points, result, scalars, environment, communicator, sqrt_n)
         {
             NTL::ZZ tmp;
             auto point = _point;
-            bool tested = false;
-            while (k < bound && !end) {
+            /// Every thread accumulates coordinates of its own points
+            Phase phase;
+            phase.started = Trace::start(_options->tracer);
+            while (!_end) {
+                bool has_scalar;
                 #pragma omp critical
                 {
-                    tmp = k;
-                    k++;
-                    counter++;
+                    has_scalar = scalars.next(tmp);
+                }
+                if (!has_scalar) {
+                    break;
                 }
 
-                point = _model->mul_points(tmp, point);
+                _multiply(phase, tmp, point);
                 if (_model->is_infinity_point(point)) {
                     break;
                 }
 
-                if (!tested && counter >= test_after) {
-                    tested = true;
-                    auto factor = _model->try_get_factor(point);
-                    if (factor > 1 && factor < *_options->composite_number) {
-                        result = factor;
+                if (phase.scalars.size() >= PHASE_LENGTH) {
+                    auto factor = _finish_phase(phase);
+                    if (factor == 0 || (factor > 1 && factor < *_options->composite_number)) {
+                        TRACE_START(waiting, _options->tracer);
                         #pragma omp critical (ending)
                         {
-                            end = 1;
+                            TRACE_SPAN_SINCE(_options->tracer, "wait ending", waiting);
+                            TRACE_SPAN(_options->tracer, "hold ending");
+                            if (factor != 0) {
+                                result = factor;
+                            }
+                            _stopping = true;
+                            _end = 1;
                         }
                         break;
                     }
                 }
 
+                /// Pending messages are polled after every scalar
+                TRACE_START(waiting, _options->tracer);
+                #pragma omp critical (ending)
+                {
+                    TRACE_SPAN_SINCE(_options->tracer, "wait ending", waiting);
+                    TRACE_SPAN(_options->tracer, "poll");
+                    if (!_end && communicator.rank() == 0) {
+                        _end = !_par_generate_ecc(environment, communicator);
+                    } else if (!_end && communicator.rank() != 0) {
+                        _end = _check_end(environment, communicator) || _end;
+                    }
+                }
+            }
+
+            auto factor = _finish_phase(phase);
+            if (factor == 0 || (factor > 1 && factor < *_options->composite_number)) {
+                TRACE_START(waiting, _options->tracer);
                 #pragma omp critical (ending)
                 {
-                    if (!end && communicator.rank() == 0) {
-                        end = !_par_generate_ecc(environment, communicator);
-                    } else if (!end && communicator.rank() != 0) {
-                        end = _check_end(environment, communicator) || end;
+                    TRACE_SPAN_SINCE(_options->tracer, "wait ending", waiting);
+                    TRACE_SPAN(_options->tracer, "hold ending");
+                    if (factor != 0) {
+                        result = factor;
                     }
+                    _stopping = true;
+                    _end = 1;
                 }
             }
 
@@ -154,24 +396,23 @@ NTL::ZZ Lenstra::_factorize_parallel(const mpi::environment &environment, const
                 points.push_back(point);
             }
 
-            #pragma omp barrier
-
-            if (counter % test_after == 0) {
-                auto factor = _model->try_get_factor(point);
-                if (factor > 1 && factor < *_options->composite_number) {
-                    result = factor;
-                    end = 1;
-                }
+            {
+                TRACE_SPAN(_options->tracer, "omp barrier");
+                #pragma omp barrier
             }
 
             #pragma omp single
             {
+                /// Factor found by some thread must not be overwritten by state of other processes
+                TRACE_START(waiting, _options->tracer);
                 #pragma omp critical (ending)
                 {
+                    TRACE_SPAN_SINCE(_options->tracer, "wait ending", waiting);
+                    TRACE_SPAN(_options->tracer, "poll");
                     if (communicator.rank() != 0)
-                        end = _check_end(environment, communicator);
+                        _end = _check_end(environment, communicator) || _end;
                     else
-                        end = !_par_generate_ecc(environment, communicator);
+                        _end = !_par_generate_ecc(environment, communicator) || _end;
                 }
                 for (const auto &vec_point : points) {
                     _point = _model->add_points(_point, vec_point);
@@ -181,16 +422,25 @@ NTL::ZZ Lenstra::_factorize_parallel(const mpi::environment &environment, const
                     auto factor = _model->try_get_factor(_point);
                     if (factor > 1 && factor < *_options->composite_number) {
                         result = factor;
-                        end = 1;
+                        _stopping = true;
+                        _end = 1;
                     }
                 }
-                if (!end) {
+                if (!_end) {
+                    if (communicator.rank() == 0) {
+                        _generated_counter++;
+                        if (_progress && !_progress(_generated_counter)) {
+                            _stopping = true;
+                            _end = 1;
+                        }
+                    }
+                }
+                if (!_end) {
                     if (communicator.rank() == 0) {
-                        generated_counter++;
                         _point = _model->generate_elliptic_curve();
-                        end = !_par_generate_ecc(environment, communicator);
+                        _end = !_par_generate_ecc(environment, communicator);
                     } else {
-                        end = !_get_ecc(environment, communicator);
+                        _end = !_get_ecc(environment, communicator);
                     }
                 }
             }
@@ -199,55 +449,84 @@ NTL::ZZ Lenstra::_factorize_parallel(const mpi::environment &environment, const
     return result;
 }
 
-void Lenstra::_generate_edwards(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
-                           int source) {
-    /// Generates edwards curve  for working process
-    auto model = dynamic_cast<EdwardsModel*>(_model.get());
-    std::stringstream buffer;
-    boost::archive::text_oarchive ar(buffer);
+template<class Model>
+long Lenstra::_prepare_wire() {
+    auto slot = NTL::NumBytes(*_options->composite_number);
+    _wire.resize(slot * (ProjectivePoint::WIRE_VALUES + Model::EllipticCurve::WIRE_VALUES));
+    return slot;
+}
+
+template<class Model>
+void Lenstra::_generate_curve(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
+                              int source) {
+    /// Generates curve for working process, point and curve parameters are sent as raw bytes in one message
+    auto model = dynamic_cast<Model*>(_model.get());
+    auto slot = _prepare_wire<Model>();
     auto point = model->generate_elliptic_curve();
-    auto curve = model->get_elliptic_curve();
+    model->get_elliptic_curve().to_bytes(point.to_bytes(_wire.data(), slot), slot);
+    _generated_counter++;
+    TRACE_SPAN(_options->tracer, "mpi send curve");
+    communicator.send(source, TAGS::NEW_ECC, _wire.data(), static_cast<int>(_wire.size()));
+}
 
-    ar << point << curve;
-    generated_counter++;
-    communicator.send(source, TAGS::NEW_ECC, buffer.str());
+template<class Model>
+void Lenstra::_store_curve() {
+    /// Point and curve are written to wire buffer in binary format
+    auto slot = _prepare_wire<Model>();
+    dynamic_cast<Model*>(_model.get())->get_elliptic_curve().to_bytes(_point.to_bytes(_wire.data(), slot), slot);
 }
 
-void Lenstra::_generate_weierstrass(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
-                               int source) {
-    /// Generates weierstrass curve for working process
-    auto model = dynamic_cast<WeierstrassModel*>(_model.get());
-    std::stringstream buffer;
-    boost::archive::text_oarchive ar(buffer);
-    auto point = model->generate_elliptic_curve();
-    auto curve = model->get_elliptic_curve();
+template<class Model>
+void Lenstra::_broadcast_curve(const boost::mpi::communicator &communicator, int root) {
+    /// Wire buffer of root is sent to all ranks, root sets point and curve from it too
+    auto model = dynamic_cast<Model*>(_model.get());
+    auto slot = _prepare_wire<Model>();
+    {
+        TRACE_SPAN(_options->tracer, "mpi broadcast curve");
+        mpi::broadcast(communicator, _wire.data(), static_cast<int>(_wire.size()), root);
+    }
+    typename Model::EllipticCurve ecc;
+    ecc.from_bytes(_point.from_bytes(_wire.data(), slot), slot);
+    model->set_elliptic_curve(ecc);
+}
 
-    ar << point << curve;
-    generated_counter++;
-    communicator.send(source, TAGS::NEW_ECC, buffer.str());
+template<class Model>
+void Lenstra::_receive_curve(const boost::mpi::communicator &communicator, const boost::mpi::status &status) {
+    /// Message is received directly to preallocated buffer
+    auto slot = _prepare_wire<Model>();
+    {
+        TRACE_SPAN(_options->tracer, "mpi recv curve");
+        communicator.recv(status.source(), status.tag(), _wire.data(), static_cast<int>(_wire.size()));
+    }
+    typename Model::EllipticCurve ecc;
+    ecc.from_bytes(_point.from_bytes(_wire.data(), slot), slot);
+    dynamic_cast<Model*>(_model.get())->set_elliptic_curve(ecc);
 }
 
 bool Lenstra::_get_ecc(const mpi::environment &environment, const mpi::communicator &communicator) {
     /// Gets new elliptic curve from master process
-    communicator.send(0, TAGS::NEW_ECC);
-    auto status = communicator.probe();
-    if (status.tag() == TAGS::NEW_ECC) {
-        std::string msg;
-        communicator.recv(status.source(), status.tag(), msg);
-        std::istringstream buffer(msg);
-        boost::archive::text_iarchive ar(buffer);
-
-        ar >> _point;
-        _point.z = 1;
+    TRACE_SPAN(_options->tracer, "get curve");
+    {
+        TRACE_SPAN(_options->tracer, "mpi send request");
+        communicator.send(0, TAGS::NEW_ECC);
+    }
+    mpi::status status;
+    {
+        TRACE_SPAN(_options->tracer, "mpi probe");
+        status = communicator.probe(0);
+    }
+    if (status.tag() == TAGS::STOP) {
+        communicator.recv(0, TAGS::STOP);
+        _stop_received = true;
+    } else if (status.tag() == TAGS::NEW_ECC) {
         if (_options->weierstrass) {
-            WeierstrassModel::EllipticCurve ecc;
-            ar >> ecc;
-            dynamic_cast<WeierstrassModel*>(_model.get())->set_elliptic_curve(ecc);
-
+            _receive_curve<WeierstrassModel>(communicator, status);
+        } else if (_options->hessian) {
+            _receive_curve<HessianModel>(communicator, status);
+        } else if (_options->jacobi) {
+            _receive_curve<JacobiIntersectionModel>(communicator, status);
         } else {
-            EdwardsModel::EllipticCurve ecc;
-            ar >> ecc;
-            dynamic_cast<EdwardsModel*>(_model.get())->set_elliptic_curve(ecc);
+            _receive_curve<EdwardsModel>(communicator, status);
         }
         return true;
     }
@@ -258,22 +537,60 @@ bool Lenstra::_check_end(const mpi::environment &environment, const mpi::communi
     /// Check if we have pending message
     auto status = communicator.iprobe();
     if (status.has_value()) {
+        TRACE_SPAN(_options->tracer, "mpi recv");
         communicator.recv(status.value().source(), status.value().tag());
     }
+    _stop_received = _stop_received || (status.has_value() && status.value().tag() == TAGS::STOP);
     return status.has_value() && status.value().tag() == TAGS::STOP;
 }
 
+void Lenstra::_finish_parallel(const mpi::environment &environment, const mpi::communicator &communicator) {
+    /// Master process stops all working processes whenever it ends, working process only master when it ended first.
+    /// Every working process ends with done tag after stop tag of master is received, master discards requests and
+    /// stop tags received before it, so no message is left for next computation on same communicator.
+    if (communicator.rank() != 0 && _stopping) {
+        _stop_all(environment, communicator);
+    }
+    if (communicator.rank() == 0) {
+        _stop_all(environment, communicator);
+        TRACE_SPAN(_options->tracer, "mpi drain");
+        for (int i = 1; i < communicator.size(); i++) {
+            for (auto status = communicator.probe(i); status.tag() != TAGS::DONE; status = communicator.probe(i)) {
+                communicator.recv(i, status.tag());
+            }
+            communicator.recv(i, TAGS::DONE);
+        }
+    } else {
+        TRACE_SPAN(_options->tracer, "mpi drain");
+        if (!_stop_received) {
+            communicator.recv(0, TAGS::STOP);
+        }
+        communicator.send(0, TAGS::DONE);
+    }
+}
+
 void Lenstra::_stop_all(const mpi::environment &, const boost::mpi::communicator& communicator) {
-    /// Send stop tag to all processses
+    /// Working processes receive only from master, so curve requested by working process is always received
+    /// before stop tag and no message with curve is left unreceived when computation ends
+    TRACE_SPAN(_options->tracer, "mpi stop all");
     std::vector<mpi::request> requests;
-    for (int i = 0; i < communicator.size(); i++) {
-        if (i != communicator.rank()) {
-            requests.emplace_back(communicator.isend(i, TAGS::STOP));
-        }
+    if (communicator.rank() != 0) {
+        requests.emplace_back(communicator.isend(0, TAGS::STOP));
+    }
+    for (int i = 1; i < communicator.size() && communicator.rank() == 0; i++) {
+        requests.emplace_back(communicator.isend(i, TAGS::STOP));
     }
     mpi::wait_all(requests.begin(), requests.end());
 }
 
+void Lenstra::set_progress(std::function<bool(const NTL::ZZ &)> progress) {
+    _progress = std::move(progress);
+}
+
+void Lenstra::set_cancelled(std::function<bool()> cancelled) {
+    _cancelled = std::move(cancelled);
+}
+
 bool Lenstra::_par_generate_ecc(const mpi::environment &environment, const mpi::communicator &communicator) {
     /// Master part with generating of new elliptic curve
     auto status = communicator.iprobe();
@@ -281,11 +598,16 @@ bool Lenstra::_par_generate_ecc(const mpi::environment &environment, const mpi::
         communicator.recv(status.value().source(), status.value().tag());
         return false;
     } else if (status.has_value() && status.value().tag() == TAGS::NEW_ECC) {
+        TRACE_SPAN(_options->tracer, "serve curve");
         communicator.recv(status.value().source(), status.value().tag());
         if (_options->weierstrass) {
-            _generate_weierstrass(environment, communicator, status.value().source());
+            _generate_curve<WeierstrassModel>(environment, communicator, status.value().source());
+        } else if (_options->hessian) {
+            _generate_curve<HessianModel>(environment, communicator, status.value().source());
+        } else if (_options->jacobi) {
+            _generate_curve<JacobiIntersectionModel>(environment, communicator, status.value().source());
         } else {
-            _generate_edwards(environment, communicator, status.value().source());
+            _generate_curve<EdwardsModel>(environment, communicator, status.value().source());
         }
     }
     return true;
@@ -3,6 +3,7 @@
 
 #include <NTL/ZZ.h>
 
+#include <functional>
 #include <utility>
 #include <boost/mpi.hpp>
 #include <boost/mpi/environment.hpp>
@@ -10,6 +11,10 @@
 
 #include "AbstractModel.h"
 #include "EdwardsModel.h"
+#include "HessianModel.h"
+#include "JacobiIntersectionModel.h"
+#include "Stages.h"
+#include "Trace.h"
 #include "WeierstrassModel.h"
 
 class Lenstra final {
@@ -21,8 +26,32 @@ public:
     /// This function is used for sequential computation of factor
     [[nodiscard]] NTL::ZZ factorize() const;
 
-    /// This function is used for parallel computation of factor
-    [[nodiscard]] NTL::ZZ factorize_parallel(int argc, char **argv);
+    /// This function is used for parallel computation of factor. MPI environment is owned by caller.
+    /// Returns factor on rank 0 and 0 on other ranks, all ranks return together.
+    /// No message is left on communicator, so more computations can run on it one after another.
+    [[nodiscard]] NTL::ZZ factorize_parallel(const boost::mpi::environment &environment,
+                                             const boost::mpi::communicator &communicator);
+
+    /// This function is used for parallel computation with stage 2 of every curve split between all ranks.
+    /// Every rank runs stage 1 of its own curve, then all ranks run stage 2 of every curve which survived it.
+    /// Returns factor on rank 0 and 0 on other ranks, all ranks return together.
+    /// Throws std::invalid_argument when bounds have no stage 2.
+    [[nodiscard]] NTL::ZZ factorize_split(const boost::mpi::environment &environment,
+                                          const boost::mpi::communicator &communicator);
+
+    /// This function sets callback which is called with number of tried curves after every curve.
+    /// When callback returns false, sequential computation stops and returns 0.
+    /// In parallel computation it is called on rank 0 with number of generated curves and stops all ranks.
+    void set_progress(std::function<bool(const NTL::ZZ &)> progress);
+
+    /// This function sets callback which is checked after every stage 1 phase, so long curves are stopped too.
+    /// When callback returns true, computation stops and returns 0.
+    void set_cancelled(std::function<bool()> cancelled);
+
+    /// Maximal number of stage 1 scalars between two GCD computations
+    static constexpr std::size_t PHASE_LENGTH = 65536;
+    /// Number of scalars between two saved points used for backtracking
+    static constexpr std::size_t CHECKPOINT_INTERVAL = 1024;
 
 private:
 
@@ -30,30 +59,95 @@ private:
     enum TAGS {
         NEW_ECC = 0x1000,
         STOP = 0x0100,
+        DONE = 0x0010,
+    };
+
+    /// States of curves gathered from all ranks in computation with split stage 2
+    enum SPLIT {
+        NEXT_CURVE,
+        STAGE_TWO,
+        FOUND,
     };
 
     std::shared_ptr<Options> _options;
     std::shared_ptr<AbstractModel> _model;
     /// Stores point for parallel purpose
     ProjectivePoint _point;
+    /// Number of curves generated by master process
+    NTL::ZZ _generated_counter{0};
+    /// Indicates that some thread or process has finished computation
+    int _end = 0;
+    /// Indicates that this process has finished computation (factor found or stopped), so others must be stopped
+    bool _stopping = false;
+    /// Indicates that working process received stop tag of master process
+    bool _stop_received = false;
+    /// Buffer for binary messages with point and curve, it is allocated once for all curves
+    std::vector<unsigned char> _wire;
+    /// Callback for reporting progress and stopping computation
+    std::function<bool(const NTL::ZZ &)> _progress;
+    /// Callback for stopping computation inside of curve
+    std::function<bool()> _cancelled;
+
+    struct Phase {
+        /// Scalars multiplied in this phase, coordinates of results are multiplied into accumulator
+        std::vector<NTL::ZZ> scalars;
+        /// Point before every CHECKPOINT_INTERVAL-th scalar
+        std::vector<ProjectivePoint> checkpoints;
+        NTL::ZZ accumulator{1};
+        /// Start of phase for tracing
+        std::int64_t started = 0;
+    };
+
+    /// Stage 1 for point, returns 1, divisor of modulus or modulus itself
+    NTL::ZZ _stage_one(const Bounds &bounds, ProjectivePoint &point) const;
+    /// Multiplies point by scalar and records this step to phase
+    void _multiply(Phase &phase, const NTL::ZZ &scalar, ProjectivePoint &point) const;
+    /// Computes GCD of accumulator and modulus (backtracking when it is modulus) and starts new phase.
+    /// Returns 0 instead of 1 when computation is cancelled.
+    NTL::ZZ _finish_phase(Phase &phase) const;
+    /// Replays phase from checkpoints with GCD after every scalar
+    [[nodiscard]] NTL::ZZ _backtrack(const Phase &phase) const;
+
+    /// Stage 2 continuation for point after stage 1. Returns GCD of accumulated coordinates and modulus.
+    [[nodiscard]] NTL::ZZ _stage_two(const Bounds &bounds, const ProjectivePoint &point) const;
+    /// Processes stage 2 blocks first, first + stride, ... by OpenMP threads and returns product of their accumulators
+    [[nodiscard]] NTL::ZZ _stage_two_blocks(const Bounds &bounds, const ProjectivePoint &point, long first,
+                                            long stride) const;
+    /// Returns product of coordinates of q * point for primes q in one stage 2 block
+    [[nodiscard]] NTL::ZZ _stage_two_block(const Bounds &bounds, const ProjectivePoint &point, long block) const;
 
     /// This method is for process computation. It uses OpenMP pragmas.
     NTL::ZZ _factorize_parallel(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator);
     /// Auxiliary function for master process. Generates new elliptic curve.
     void _generate_ecc(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator);
-    /// Auxiliary function for master process. Generates and sends new Edwards curve to working process specified by source argument.
-    void _generate_edwards(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
-                           int source);
-    /// Auxiliary function for master process. Generates and sends new Weierstrass curve to working process specified by source argument.
-    void _generate_weierstrass(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
-                               int source);
+    /// Auxiliary function for master process. Generates and sends new curve of Model to working process specified by source argument.
+    template<class Model>
+    void _generate_curve(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator,
+                         int source);
+    /// Auxiliary function for working process. Receives point and curve of Model from master process.
+    template<class Model>
+    void _receive_curve(const boost::mpi::communicator &communicator, const boost::mpi::status &status);
+    /// Writes point and curve of model to wire buffer
+    void _store_curve();
+    template<class Model>
+    void _store_curve();
+    /// Sends wire buffer of root to all ranks, every rank sets point and curve from it
+    void _broadcast_curve(const boost::mpi::communicator &communicator, int root);
+    template<class Model>
+    void _broadcast_curve(const boost::mpi::communicator &communicator, int root);
+    /// Returns size of slot for one value and resizes wire buffer for point and curve of Model
+    template<class Model>
+    long _prepare_wire();
     /// Auxiliary function for working process. Gets new elliptic curve for working process.
     bool _get_ecc(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator);
 
+    /// Stops other processes and receives all messages left by parallel computation
+    void _finish_parallel(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator);
+
     /// Auxiliary function for checking if some process finished it's job.
     bool _check_end(const boost::mpi::environment &environment, const boost::mpi::communicator &communicator);
 
-    /// This function sends message to all other processes with end indication
+    /// Working process sends end indication to master process, master process sends it to all working processes
     void _stop_all(const boost::mpi::environment &, const boost::mpi::communicator& communicator);
 
     /// Auxiliary function for
@@ -2,15 +2,52 @@
 #define DIP_OPTIONS_H
 
 #include <NTL/ZZ.h>
+#include <memory>
+#include <string>
+
+class Trace;
 
 struct Options {
     /// This struct stores options from command-line
+    /// Default size of modulus in bits from which reducing every product in curve arithmetic is faster
+    static constexpr long LARGE_MODULUS_THRESHOLD = 512;
+    /// Default size of modulus in bits from which Barrett reduction is faster than division
+    static constexpr long BARRETT_THRESHOLD = 16384;
     std::shared_ptr<NTL::ZZ> composite_number = std::make_shared<NTL::ZZ>();
     bool edwards = false;
     bool weierstrass = false;
+    bool hessian = false;
+    bool jacobi = false;
     std::shared_ptr<NTL::ZZ> bound = std::make_shared<NTL::ZZ>(0);
+    /// Bound for stage 2 (0 means default of chosen method)
+    std::shared_ptr<NTL::ZZ> bound2 = std::make_shared<NTL::ZZ>(0);
     bool timer = false;
     bool parallel = false;
+    /// In parallel mode every rank runs stage 1 of its own curve and stage 2 of every curve is split between all ranks
+    bool split_stage_two = false;
+    /// Use Pollard p-1 method instead of ECM
+    bool pm1 = false;
+    /// Use Williams p+1 method instead of ECM
+    bool pp1 = false;
+    /// Try p-1 and p+1 methods before ECM
+    bool first_pass = false;
+    /// Moduli with at least this many bits are reduced after every product in curve arithmetic (0 disables)
+    long large_modulus_threshold = LARGE_MODULUS_THRESHOLD;
+    /// Moduli with at least this many bits are reduced by Barrett reduction instead of division (0 disables)
+    long barrett_threshold = BARRETT_THRESHOLD;
+    /// Numbers with at most this many digits are factorized by quadratic sieve after short ECM pretest (0 disables sieve)
+    long qs_threshold = 90;
+    /// File for trace of computation in trace event format (empty disables tracing)
+    std::string trace;
+    /// Trace collecting spans of computation, it is shared by copies of options (nullptr disables tracing)
+    std::shared_ptr<Trace> tracer;
+    /// File of effort database, known factors are returned from it and ECM continues where previous runs stopped
+    std::string effort_db;
+
+    /// Returns name of chosen curve model
+    [[nodiscard]] const char *model() const noexcept {
+        return hessian ? "hessian" : jacobi ? "jacobi" : edwards ? "edwards" : "weierstrass";
+    }
 };
 
 #endif //DIP_OPTIONS_H
@@ -0,0 +1,37 @@
+#include "PollardPM1.h"
+
+#include <map>
+
+NTL::ZZ PollardPM1::factorize() const {
+    const auto &n = *_options->composite_number;
+    Bounds bounds(*_options, NTL::ZZ(DEFAULT_BOUND), STAGE_TWO_FACTOR);
+
+    NTL::ZZ a{3};
+    auto divisor = stage_one(bounds, n, a, [&](const NTL::ZZ &value, const NTL::ZZ &scalar) {
+        return NTL::PowerMod(value, scalar, n);
+    }, [](const NTL::ZZ &value) {
+        return value - 1;
+    });
+    if (divisor > 1 && divisor < n) {
+        return divisor;
+    }
+
+    /// Stage 2 computes a^q for every prime q in (B1, B2], powers a^gap are cached
+    std::map<long, NTL::ZZ> gaps;
+    NTL::ZZ x;
+    divisor = stage_two(bounds, n, [&](long prime) {
+        x = NTL::PowerMod(a, prime, n);
+        return x - 1;
+    }, [&](long gap) {
+        auto cached = gaps.find(gap);
+        if (cached == gaps.end()) {
+            cached = gaps.emplace(gap, NTL::PowerMod(a, gap, n)).first;
+        }
+        x = NTL::MulMod(x, cached->second, n);
+        return x - 1;
+    });
+    if (divisor > 1 && divisor < n) {
+        return divisor;
+    }
+    return NTL::ZZ{0};
+}
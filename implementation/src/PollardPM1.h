@@ -0,0 +1,31 @@
+#ifndef DIP_POLLARDPM1_H
+#define DIP_POLLARDPM1_H
+
+#include <NTL/ZZ.h>
+
+#include <memory>
+#include <utility>
+
+#include "Options.h"
+#include "Stages.h"
+
+class PollardPM1 final {
+    /// Pollard p-1 method. It finds factor p when p - 1 is B1-powersmooth up to one prime in (B1, B2].
+public:
+    explicit PollardPM1(std::shared_ptr<Options> options) : _options(std::move(options)) {
+    }
+
+    /// Default B1 when it is not set from command-line
+    static constexpr long DEFAULT_BOUND = 1000000;
+    /// Default B2 is multiple of B1
+    static constexpr long STAGE_TWO_FACTOR = 100;
+
+    /// This function returns found factor or 0
+    [[nodiscard]] NTL::ZZ factorize() const;
+
+private:
+    std::shared_ptr<Options> _options;
+};
+
+
+#endif //DIP_POLLARDPM1_H
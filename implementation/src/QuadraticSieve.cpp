@@ -0,0 +1,628 @@
+#include "QuadraticSieve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <omp.h>
+
+/// Primes smaller than this are not sieved, they are handled only by trial division
+static constexpr long SIEVE_START_PRIME = 30;
+/// Number of relations collected over number of factor base columns
+static constexpr long EXTRA_RELATIONS = 32;
+/// Lowers sieve threshold in bits for contribution of small primes which are not sieved
+static constexpr double SMALL_PRIMES_FUDGE = 4.0;
+/// Candidate has highest bit of sieve byte set
+static constexpr std::uint64_t CANDIDATE_MASK = 0x8080808080808080ULL;
+
+struct QuadraticSieve::Polynomial {
+    /// Polynomial Q(x) = A x^2 + 2 B x + C, for which (A x + B)^2 - N = A Q(x)
+    NTL::ZZ a, b, c;
+    /// B is sum of +-b_terms[l], signs are switched by Gray code
+    std::vector<NTL::ZZ> b_terms;
+    std::vector<int> signs;
+    /// Factor base indices of primes dividing A
+    std::vector<long> a_indices;
+    std::vector<char> divides_a;
+    /// Roots of Q(x) modulo every factor base prime
+    std::vector<long> root1, root2;
+    /// 2 * b_terms[l] * A^-1 modulo every factor base prime
+    std::vector<std::vector<long>> b_ainv2;
+};
+
+bool QuadraticSieve::is_suitable(const Options &options) {
+    auto length = digits(*options.composite_number);
+    return options.qs_threshold > 0 && length >= MIN_DIGITS && length <= options.qs_threshold;
+}
+
+void QuadraticSieve::set_progress(std::function<bool(const NTL::ZZ &)> progress) {
+    _progress = std::move(progress);
+}
+
+QuadraticSieve::Parameters QuadraticSieve::_parameters(long digits) {
+    /// Factor base sizes and sieve lengths tuned for 32 kB blocks
+    static const std::vector<Parameters> table{
+            {20, 80, 1, 30},
+            {25, 120, 1, 30},
+            {30, 180, 1, 40},
+            {35, 260, 1, 40},
+            {40, 380, 1, 50},
+            {45, 560, 1, 50},
+            {50, 800, 2, 60},
+            {55, 1100, 2, 70},
+            {60, 1600, 3, 80},
+            {65, 2300, 4, 90},
+            {70, 3200, 5, 100},
+            {75, 4500, 6, 100},
+            {80, 6000, 7, 110},
+            {85, 8000, 8, 120},
+            {90, 10500, 10, 120},
+            {95, 13000, 12, 128},
+            {100, 16000, 14, 128},
+    };
+    for (const auto &parameters : table) {
+        if (digits <= parameters.digits) {
+            return parameters;
+        }
+    }
+    return table.back();
+}
+
+long QuadraticSieve::digits(const NTL::ZZ &n) {
+    std::ostringstream buffer;
+    buffer << n;
+    return static_cast<long>(buffer.str().size());
+}
+
+NTL::ZZ QuadraticSieve::factorize() const {
+    const auto &n = *_options->composite_number;
+    auto parameters = _parameters(digits(n));
+
+    /// Sieve can not factorize squares
+    auto root = NTL::SqrRoot(n);
+    if (root * root == n) {
+        return root;
+    }
+
+    std::vector<Prime> primes;
+    auto divisor = _factor_base(parameters, primes);
+    if (divisor != 0) {
+        return divisor < n ? divisor : NTL::ZZ{0};
+    }
+
+    const long interval = parameters.blocks * BLOCK_SIZE;
+    const long biggest = primes.back().p;
+    const long large_prime_bound = std::min(biggest * parameters.large_prime_multiplier, biggest * biggest);
+
+    /// |Q(x)| is at most M sqrt(N / 2), relations may contain one large prime
+    const double max_bits = std::log2(static_cast<double>(interval)) + NTL::NumBits(n) / 2.0 - 0.5;
+    const double threshold_bits = max_bits - std::log2(static_cast<double>(large_prime_bound)) - SMALL_PRIMES_FUDGE;
+    const double scale = std::min(1.0, 100.0 / max_bits);
+    for (auto &prime : primes) {
+        prime.log = static_cast<unsigned char>(std::lround(std::log2(static_cast<double>(prime.p)) * scale));
+    }
+    const auto threshold = static_cast<unsigned char>(std::lround(std::max(threshold_bits, 1.0) * scale));
+
+    const auto target = NTL::SqrRoot(n << 1) / interval;
+    const auto needed = static_cast<std::size_t>(primes.size() + 1 + EXTRA_RELATIONS);
+
+    std::vector<Relation> relations;
+    std::map<long, Relation> partials;
+    std::set<std::vector<long>> used;
+    bool done = false, cancelled = false;
+
+    #pragma omp parallel shared(relations, partials, used, done, cancelled)
+    {
+        std::vector<Relation> full, partial;
+        std::vector<long> a_indices;
+        while (true) {
+            bool stop;
+            #pragma omp critical (qs_relations)
+            {
+                stop = done;
+                if (!stop && !_choose_a(primes, target, used, a_indices)) {
+                    done = stop = true;
+                }
+            }
+            if (stop) {
+                break;
+            }
+
+            full.clear();
+            partial.clear();
+            _sieve(primes, parameters, large_prime_bound, threshold, a_indices, full, partial);
+
+            #pragma omp critical (qs_relations)
+            {
+                relations.insert(relations.end(), full.begin(), full.end());
+                /// Two partial relations with same large prime give one full relation
+                for (auto &relation : partial) {
+                    auto stored = partials.find(relation.large_prime);
+                    if (stored == partials.end()) {
+                        partials.emplace(relation.large_prime, std::move(relation));
+                        continue;
+                    }
+                    Relation combined;
+                    combined.y = NTL::MulMod(stored->second.y, relation.y, n);
+                    combined.factors = stored->second.factors;
+                    combined.factors.insert(combined.factors.end(), relation.factors.begin(), relation.factors.end());
+                    combined.large_prime = relation.large_prime;
+                    relations.push_back(std::move(combined));
+                }
+                if (relations.size() >= needed) {
+                    done = true;
+                }
+                if (!done && _progress && !_progress(NTL::conv<NTL::ZZ>(static_cast<long>(relations.size())))) {
+                    done = cancelled = true;
+                }
+            }
+        }
+    }
+
+    if (cancelled || relations.size() < needed) {
+        return NTL::ZZ{0};
+    }
+    return _linear_algebra(primes, relations);
+}
+
+long QuadraticSieve::_sqrt_mod(long n, long p) {
+    /// Tonelli-Shanks algorithm, n must be quadratic residue modulo p
+    n %= p;
+    if (p == 2 || n == 0) {
+        return n;
+    }
+    long q = p - 1, s = 0;
+    while ((q & 1) == 0) {
+        q >>= 1;
+        s++;
+    }
+    long z = 2;
+    while (NTL::PowerMod(z, (p - 1) >> 1, p) != p - 1) {
+        z++;
+    }
+    long m = s, c = NTL::PowerMod(z, q, p), t = NTL::PowerMod(n, q, p), r = NTL::PowerMod(n, (q + 1) >> 1, p);
+    while (t != 1) {
+        long i = 0;
+        for (long square = t; square != 1; i++) {
+            square = NTL::MulMod(square, square, p);
+        }
+        long b = c;
+        for (long j = 0; j < m - i - 1; j++) {
+            b = NTL::MulMod(b, b, p);
+        }
+        m = i;
+        c = NTL::MulMod(b, b, p);
+        t = NTL::MulMod(t, c, p);
+        r = NTL::MulMod(r, b, p);
+    }
+    return r;
+}
+
+NTL::ZZ QuadraticSieve::_factor_base(const Parameters &parameters, std::vector<Prime> &primes) const {
+    /// Factor base contains 2 and odd primes p for which N is quadratic residue modulo p
+    const auto &n = *_options->composite_number;
+    primes.clear();
+    primes.push_back({2, 1, 0});
+    NTL::PrimeSeq sequence;
+    sequence.next();
+    while (static_cast<long>(primes.size()) < parameters.factor_base) {
+        long p = sequence.next();
+        long residue = NTL::rem(n, p);
+        if (residue == 0) {
+            return NTL::ZZ(p);
+        }
+        if (NTL::PowerMod(residue, (p - 1) >> 1, p) == 1) {
+            primes.push_back({p, _sqrt_mod(residue, p), 0});
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+bool QuadraticSieve::_choose_a(const std::vector<Prime> &primes, const NTL::ZZ &target,
+                               std::set<std::vector<long>> &used, std::vector<long> &indices) const {
+    /// A is product of s primes close to target^(1/s), so that A is close to sqrt(2 N) / M
+    const auto size = static_cast<long>(primes.size());
+    long min_index = 1;
+    while (min_index < size - 1 && primes[min_index].p < SIEVE_START_PRIME) {
+        min_index++;
+    }
+    const double log_target = std::max(NTL::log(target), 0.0);
+    long s = std::max(1L, std::lround(log_target / std::log(2000.0)));
+    while (s > 1 && std::exp(log_target / s) < primes[min_index].p) {
+        s--;
+    }
+    while (s < size - min_index && std::exp(log_target / s) > primes.back().p) {
+        s++;
+    }
+
+    auto closest = [&](double value) {
+        auto found = std::lower_bound(primes.begin() + min_index, primes.end(), value,
+                                      [](const Prime &prime, double value) { return prime.p < value; });
+        if (found == primes.end()) {
+            return size - 1;
+        }
+        auto index = static_cast<long>(found - primes.begin());
+        if (index > min_index && value - primes[index - 1].p < primes[index].p - value) {
+            index--;
+        }
+        return index;
+    };
+
+    const long ideal = closest(std::exp(log_target / s));
+    long width = std::max(4L, size / 16);
+    for (long attempt = 1; attempt <= 1000; attempt++) {
+        if (attempt % 20 == 0) {
+            width <<= 1;
+        }
+        const long low = std::max(min_index, ideal - width), high = std::min(size - 1, ideal + width);
+        indices.clear();
+        double log_product = 0;
+        while (static_cast<long>(indices.size()) < s - 1 && static_cast<long>(indices.size()) <= high - low) {
+            long index = low + NTL::RandomBnd(high - low + 1);
+            if (std::find(indices.begin(), indices.end(), index) == indices.end()) {
+                indices.push_back(index);
+                log_product += std::log(static_cast<double>(primes[index].p));
+            }
+        }
+        /// Last prime corrects product to be close to target
+        long last = closest(std::exp(log_target - log_product));
+        while (last < size && std::find(indices.begin(), indices.end(), last) != indices.end()) {
+            last++;
+        }
+        if (last >= size) {
+            continue;
+        }
+        indices.push_back(last);
+        std::sort(indices.begin(), indices.end());
+        if (used.insert(indices).second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QuadraticSieve::_initialize(const std::vector<Prime> &primes, const std::vector<long> &a_indices,
+                                 Polynomial &polynomial) const {
+    const auto &n = *_options->composite_number;
+    const auto size = primes.size();
+    polynomial.a_indices = a_indices;
+    polynomial.divides_a.assign(size, 0);
+    polynomial.a = 1;
+    for (auto index : a_indices) {
+        polynomial.a *= primes[index].p;
+        polynomial.divides_a[index] = 1;
+    }
+
+    /// b_terms[l] is divisible by all primes of A except q_l and b_terms[l]^2 = N modulo q_l
+    polynomial.b_terms.clear();
+    polynomial.b = 0;
+    for (auto index : a_indices) {
+        long q = primes[index].p;
+        auto rest = polynomial.a / q;
+        long gamma = NTL::MulMod(primes[index].sqrt_n, NTL::InvMod(NTL::rem(rest, q), q), q);
+        if (gamma > q / 2) {
+            gamma = q - gamma;
+        }
+        polynomial.b_terms.push_back(rest * gamma);
+        polynomial.b += polynomial.b_terms.back();
+    }
+    polynomial.signs.assign(a_indices.size(), 1);
+    polynomial.c = (polynomial.b * polynomial.b - n) / polynomial.a;
+
+    polynomial.root1.assign(size, 0);
+    polynomial.root2.assign(size, 0);
+    polynomial.b_ainv2.assign(a_indices.size(), std::vector<long>(size, 0));
+    for (std::size_t j = 1; j < size; j++) {
+        if (polynomial.divides_a[j]) {
+            continue;
+        }
+        long p = primes[j].p, t = primes[j].sqrt_n;
+        long a_inverse = NTL::InvMod(NTL::rem(polynomial.a, p), p);
+        long b = NTL::rem(polynomial.b, p);
+        polynomial.root1[j] = NTL::MulMod(a_inverse, (t - b + p) % p, p);
+        polynomial.root2[j] = NTL::MulMod(a_inverse, ((p - t) % p - b + p) % p, p);
+        for (std::size_t l = 0; l < a_indices.size(); l++) {
+            polynomial.b_ainv2[l][j] = NTL::MulMod((NTL::rem(polynomial.b_terms[l], p) << 1) % p, a_inverse, p);
+        }
+    }
+}
+
+void QuadraticSieve::_next_polynomial(const std::vector<Prime> &primes, long index, Polynomial &polynomial) const {
+    /// Gray code switches sign of one b_term, roots x = A^-1 (+-t - B) move by +-2 b_term A^-1
+    const auto &n = *_options->composite_number;
+    long l = 0;
+    while (((index >> l) & 1) == 0) {
+        l++;
+    }
+    const int sign = polynomial.signs[l];
+    if (sign > 0) {
+        polynomial.b -= polynomial.b_terms[l] << 1;
+    } else {
+        polynomial.b += polynomial.b_terms[l] << 1;
+    }
+    polynomial.signs[l] = -sign;
+    polynomial.c = (polynomial.b * polynomial.b - n) / polynomial.a;
+
+    const auto &delta = polynomial.b_ainv2[l];
+    for (std::size_t j = 1; j < primes.size(); j++) {
+        long p = primes[j].p;
+        long shift = sign > 0 ? delta[j] : p - delta[j];
+        polynomial.root1[j] += shift;
+        if (polynomial.root1[j] >= p) {
+            polynomial.root1[j] -= p;
+        }
+        polynomial.root2[j] += shift;
+        if (polynomial.root2[j] >= p) {
+            polynomial.root2[j] -= p;
+        }
+    }
+}
+
+void QuadraticSieve::_sieve(const std::vector<Prime> &primes, const Parameters &parameters, long large_prime_bound,
+                            unsigned char threshold, const std::vector<long> &a_indices,
+                            std::vector<Relation> &full, std::vector<Relation> &partial) const {
+    Polynomial polynomial;
+    _initialize(primes, a_indices, polynomial);
+
+    const long interval = parameters.blocks * BLOCK_SIZE;
+    const long polynomials = 1L << (a_indices.size() - 1);
+    std::size_t start = 1;
+    while (start < primes.size() && primes[start].p < SIEVE_START_PRIME) {
+        start++;
+    }
+    /// Bytes start below 128 and candidate crosses threshold when its highest bit is set
+    const auto initial = static_cast<unsigned char>(128 - threshold);
+    std::vector<unsigned char> sieve(BLOCK_SIZE);
+    Relation relation;
+
+    for (long index = 0; index < polynomials; index++) {
+        if (index > 0) {
+            _next_polynomial(primes, index, polynomial);
+        }
+        for (long block = 0; block < 2 * parameters.blocks; block++) {
+            const long x0 = block * BLOCK_SIZE - interval;
+            std::memset(sieve.data(), initial, BLOCK_SIZE);
+            for (std::size_t j = start; j < primes.size(); j++) {
+                if (polynomial.divides_a[j]) {
+                    continue;
+                }
+                const long p = primes[j].p;
+                const unsigned char log = primes[j].log;
+                long offset = x0 % p;
+                if (offset < 0) {
+                    offset += p;
+                }
+                long position = polynomial.root1[j] - offset;
+                if (position < 0) {
+                    position += p;
+                }
+                for (; position < BLOCK_SIZE; position += p) {
+                    sieve[position] += log;
+                }
+                if (polynomial.root2[j] == polynomial.root1[j]) {
+                    continue;
+                }
+                position = polynomial.root2[j] - offset;
+                if (position < 0) {
+                    position += p;
+                }
+                for (; position < BLOCK_SIZE; position += p) {
+                    sieve[position] += log;
+                }
+            }
+
+            for (long word = 0; word < BLOCK_SIZE; word += 8) {
+                std::uint64_t value;
+                std::memcpy(&value, sieve.data() + word, sizeof(value));
+                if ((value & CANDIDATE_MASK) == 0) {
+                    continue;
+                }
+                for (long position = word; position < word + 8; position++) {
+                    if ((sieve[position] & 0x80) == 0 ||
+                        !_trial_divide(primes, polynomial, x0 + position, large_prime_bound, relation)) {
+                        continue;
+                    }
+                    if (relation.large_prime == 1) {
+                        full.push_back(relation);
+                    } else {
+                        partial.push_back(relation);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool QuadraticSieve::_trial_divide(const std::vector<Prime> &primes, const Polynomial &polynomial, long x,
+                                   long large_prime_bound, Relation &relation) const {
+    const auto &n = *_options->composite_number;
+    const NTL::ZZ zz_x(x);
+    NTL::ZZ value = (polynomial.a * zz_x + (polynomial.b << 1)) * zz_x + polynomial.c;
+    if (value == 0) {
+        return false;
+    }
+    relation.factors.clear();
+    if (value < 0) {
+        relation.factors.push_back(0);
+        value = -value;
+    }
+    for (std::size_t j = 0; j < primes.size(); j++) {
+        const long p = primes[j].p;
+        bool divides;
+        if (j == 0 || polynomial.divides_a[j]) {
+            divides = NTL::rem(value, p) == 0;
+        } else {
+            long residue = x % p;
+            if (residue < 0) {
+                residue += p;
+            }
+            divides = residue == polynomial.root1[j] || residue == polynomial.root2[j];
+        }
+        if (!divides) {
+            continue;
+        }
+        while (NTL::rem(value, p) == 0) {
+            value /= p;
+            relation.factors.push_back(static_cast<long>(j) + 1);
+        }
+    }
+    if (value >= large_prime_bound) {
+        return false;
+    }
+    /// (A x + B)^2 = A Q(x), so primes of A are added to factors
+    for (auto index : polynomial.a_indices) {
+        relation.factors.push_back(index + 1);
+    }
+    relation.large_prime = NTL::conv<long>(value);
+    relation.y = (polynomial.a * zz_x + polynomial.b) % n;
+    return true;
+}
+
+NTL::ZZ QuadraticSieve::_linear_algebra(const std::vector<Prime> &primes, const std::vector<Relation> &relations) const {
+    /// Relations with singleton columns can not be part of any dependency, so they are filtered out first,
+    /// the rest is solved by dense elimination over GF(2) with identity matrix tracking combinations
+    const auto columns = static_cast<long>(primes.size()) + 1;
+    std::vector<std::vector<long>> odd(relations.size());
+    std::vector<long> weight(columns, 0);
+    for (std::size_t i = 0; i < relations.size(); i++) {
+        auto factors = relations[i].factors;
+        std::sort(factors.begin(), factors.end());
+        for (std::size_t j = 0; j < factors.size();) {
+            std::size_t k = j;
+            while (k < factors.size() && factors[k] == factors[j]) {
+                k++;
+            }
+            if ((k - j) & 1) {
+                odd[i].push_back(factors[j]);
+                weight[factors[j]]++;
+            }
+            j = k;
+        }
+    }
+
+    std::vector<char> active(relations.size(), 1);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 0; i < relations.size(); i++) {
+            if (!active[i]) {
+                continue;
+            }
+            bool singleton = std::any_of(odd[i].begin(), odd[i].end(), [&](long column) { return weight[column] == 1; });
+            if (singleton) {
+                active[i] = 0;
+                changed = true;
+                for (auto column : odd[i]) {
+                    weight[column]--;
+                }
+            }
+        }
+    }
+
+    std::vector<long> column_index(columns, -1);
+    long used_columns = 0;
+    for (long column = 0; column < columns; column++) {
+        if (weight[column] > 0) {
+            column_index[column] = used_columns++;
+        }
+    }
+    std::vector<long> rows;
+    for (std::size_t i = 0; i < relations.size(); i++) {
+        if (active[i] && static_cast<long>(rows.size()) < used_columns + EXTRA_RELATIONS) {
+            rows.push_back(static_cast<long>(i));
+        }
+    }
+
+    const auto row_count = static_cast<long>(rows.size());
+    const long column_words = (used_columns + 63) / 64, identity_words = (row_count + 63) / 64;
+    const long width = column_words + identity_words;
+    std::vector<std::uint64_t> matrix(row_count * width, 0);
+    for (long r = 0; r < row_count; r++) {
+        auto *row = &matrix[r * width];
+        for (auto column : odd[rows[r]]) {
+            long mapped = column_index[column];
+            row[mapped / 64] ^= 1ULL << (mapped % 64);
+        }
+        row[column_words + r / 64] |= 1ULL << (r % 64);
+    }
+
+    /// Thread team is created once for whole elimination, one thread chooses pivot of every column
+    /// and all threads share reduction of rows below it
+    long rank = 0, current = -1;
+    #pragma omp parallel shared(matrix, rank, current)
+    for (long column = 0; column < used_columns; column++) {
+        const long word = column / 64;
+        const std::uint64_t mask = 1ULL << (column % 64);
+        #pragma omp single
+        {
+            long pivot = rank;
+            while (pivot < row_count && !(matrix[pivot * width + word] & mask)) {
+                pivot++;
+            }
+            current = pivot < row_count ? rank : -1;
+            if (current >= 0) {
+                if (pivot != rank) {
+                    std::swap_ranges(matrix.begin() + pivot * width, matrix.begin() + (pivot + 1) * width,
+                                     matrix.begin() + rank * width);
+                }
+                rank++;
+            }
+        }
+        /// Pivot is read by every thread before single of next column can change it
+        const long pivot_index = current;
+        #pragma omp barrier
+        if (pivot_index < 0) {
+            continue;
+        }
+        const auto *pivot_row = &matrix[pivot_index * width];
+        #pragma omp for
+        for (long r = pivot_index + 1; r < row_count; r++) {
+            auto *row = &matrix[r * width];
+            if (row[word] & mask) {
+                for (long w = word; w < width; w++) {
+                    row[w] ^= pivot_row[w];
+                }
+            }
+        }
+    }
+
+    /// Rows with zero column part are dependencies
+    const auto &n = *_options->composite_number;
+    for (long r = rank; r < row_count; r++) {
+        const auto *row = &matrix[r * width];
+        std::vector<long> dependency;
+        for (long i = 0; i < row_count; i++) {
+            if (row[column_words + i / 64] & (1ULL << (i % 64))) {
+                dependency.push_back(rows[i]);
+            }
+        }
+        auto divisor = _square_root(primes, relations, dependency);
+        if (divisor > 1 && divisor < n) {
+            return divisor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+NTL::ZZ QuadraticSieve::_square_root(const std::vector<Prime> &primes, const std::vector<Relation> &relations,
+                                     const std::vector<long> &dependency) const {
+    /// X^2 = Y^2 modulo N, where X is product of y and Y is square root of product of factors
+    const auto &n = *_options->composite_number;
+    std::vector<long> exponents(primes.size() + 1, 0);
+    NTL::ZZ x{1}, y{1};
+    for (auto index : dependency) {
+        const auto &relation = relations[index];
+        x = NTL::MulMod(x, relation.y, n);
+        for (auto column : relation.factors) {
+            exponents[column]++;
+        }
+        if (relation.large_prime != 1) {
+            y = NTL::MulMod(y, NTL::ZZ(relation.large_prime), n);
+        }
+    }
+    for (std::size_t column = 1; column < exponents.size(); column++) {
+        if (exponents[column] > 0) {
+            y = NTL::MulMod(y, NTL::PowerMod(NTL::ZZ(primes[column - 1].p), exponents[column] >> 1, n), n);
+        }
+    }
+    return NTL::GCD(x - y, n);
+}
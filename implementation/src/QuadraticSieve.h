@@ -0,0 +1,111 @@
+#ifndef DIP_QUADRATICSIEVE_H
+#define DIP_QUADRATICSIEVE_H
+
+#include <NTL/ZZ.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Options.h"
+
+class QuadraticSieve final {
+    /// Self-initialising quadratic sieve (SIQS). Its running time depends only on size of composite number,
+    /// so for balanced semiprimes up to about 90 digits it is faster than ECM.
+public:
+    explicit QuadraticSieve(std::shared_ptr<Options> options) : _options(std::move(options)) {
+    }
+
+    /// Smallest number of digits for which sieve parameters are defined
+    static constexpr long MIN_DIGITS = 20;
+    /// Size of one sieve block in bytes, it fits into L1 data cache
+    static constexpr long BLOCK_SIZE = 32768;
+
+    /// Number of decimal digits of n
+    [[nodiscard]] static long digits(const NTL::ZZ &n);
+
+    /// This function returns true if composite number in options should be factorized by SIQS
+    [[nodiscard]] static bool is_suitable(const Options &options);
+
+    /// This function returns found factor or 0
+    [[nodiscard]] NTL::ZZ factorize() const;
+
+    /// This function sets callback which is called with number of relations after every polynomial batch.
+    /// When callback returns false, computation stops and returns 0.
+    void set_progress(std::function<bool(const NTL::ZZ &)> progress);
+
+private:
+    struct Parameters {
+        long digits;
+        /// Number of primes in factor base
+        long factor_base;
+        /// Number of blocks in half of sieve interval [-M, M)
+        long blocks;
+        /// Large prime bound is this multiple of biggest prime in factor base
+        long large_prime_multiplier;
+    };
+
+    struct Prime {
+        long p;
+        /// Square root of composite number modulo p
+        long sqrt_n;
+        /// Scaled logarithm of p used in sieve
+        unsigned char log;
+    };
+
+    struct Relation {
+        /// Relation y^2 = product of factor base elements (times large prime squared) modulo composite number
+        NTL::ZZ y;
+        /// Column indices with multiplicity, column 0 is -1, column i + 1 is i-th prime of factor base
+        std::vector<long> factors;
+        /// Large prime or 1
+        long large_prime = 1;
+    };
+
+    struct Polynomial;
+
+    std::shared_ptr<Options> _options;
+    std::function<bool(const NTL::ZZ &)> _progress;
+
+    /// Sieve parameters for given number of digits
+    [[nodiscard]] static Parameters _parameters(long digits);
+
+    /// Builds factor base, returns divisor of composite number if some small prime divides it
+    [[nodiscard]] NTL::ZZ _factor_base(const Parameters &parameters, std::vector<Prime> &primes) const;
+
+    /// Chooses new coefficient A as product of factor base primes, used values are stored to used
+    [[nodiscard]] bool _choose_a(const std::vector<Prime> &primes, const NTL::ZZ &target,
+                                 std::set<std::vector<long>> &used, std::vector<long> &indices) const;
+
+    /// Sieves all polynomials with given A and returns found full and partial relations
+    void _sieve(const std::vector<Prime> &primes, const Parameters &parameters, long large_prime_bound,
+                unsigned char threshold, const std::vector<long> &a_indices,
+                std::vector<Relation> &full, std::vector<Relation> &partial) const;
+
+    /// Computes coefficients B, C and roots of first polynomial with given A
+    void _initialize(const std::vector<Prime> &primes, const std::vector<long> &a_indices, Polynomial &polynomial) const;
+
+    /// Switches polynomial to next one by Gray code, index is number of next polynomial
+    void _next_polynomial(const std::vector<Prime> &primes, long index, Polynomial &polynomial) const;
+
+    /// Square root of n modulo prime p
+    [[nodiscard]] static long _sqrt_mod(long n, long p);
+
+    /// Trial division of candidate x of polynomial, returns false if it is not (partial) relation
+    bool _trial_divide(const std::vector<Prime> &primes, const Polynomial &polynomial, long x, long large_prime_bound,
+                       Relation &relation) const;
+
+    /// Finds dependencies among relations and tries to compute factor from them
+    [[nodiscard]] NTL::ZZ _linear_algebra(const std::vector<Prime> &primes, const std::vector<Relation> &relations) const;
+
+    /// Computes factor from one dependency
+    [[nodiscard]] NTL::ZZ _square_root(const std::vector<Prime> &primes, const std::vector<Relation> &relations,
+                                       const std::vector<long> &dependency) const;
+};
+
+
+#endif //DIP_QUADRATICSIEVE_H
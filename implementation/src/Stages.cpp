@@ -0,0 +1,94 @@
+#include "Stages.h"
+
+#include <algorithm>
+#include <limits>
+
+Bounds::Bounds(const Options &options, const NTL::ZZ &default_bound, long stage_two_factor) {
+    auto sqrt_n = NTL::SqrRoot(*options.composite_number);
+    stage_one = (default_bound < sqrt_n ? default_bound : sqrt_n);
+    if (*options.bound > 2)
+        stage_one = (*options.bound < sqrt_n ? *options.bound : sqrt_n);
+
+    /// Stage 2 is iterated with machine words, so B2 is clamped to long
+    const NTL::ZZ max_stage_two{std::numeric_limits<long>::max() / 2};
+    NTL::ZZ stage_two_bound{0};
+    if (*options.bound2 > 0) {
+        stage_two_bound = *options.bound2;
+    } else if (stage_two_factor > 0) {
+        stage_two_bound = stage_one * stage_two_factor;
+    }
+    if (stage_two_bound > max_stage_two) {
+        stage_two_bound = max_stage_two;
+    }
+    stage_two = NTL::conv<long>(stage_two_bound);
+}
+
+bool PrimePowers::next(NTL::ZZ &scalar) {
+    /// Primes are taken from small prime sequence as long as possible, bigger primes are found by NextPrime
+    long small = _prime < NTL_SP_BOUND ? _primes.next() : 0;
+    if (small != 0) {
+        _prime = small;
+    } else {
+        _prime = NTL::NextPrime(_prime + 1);
+    }
+    if (_prime > _bound) {
+        return false;
+    }
+    scalar = _prime;
+    while (scalar * _prime <= _bound) {
+        scalar *= _prime;
+    }
+    return true;
+}
+
+long Bounds::stage_two_blocks() const {
+    if (!has_stage_two()) {
+        return 0;
+    }
+    return (stage_two - NTL::conv<long>(stage_one) + STAGE_TWO_BLOCK - 1) / STAGE_TWO_BLOCK;
+}
+
+std::pair<long, long> Bounds::stage_two_block(long index) const {
+    auto low = NTL::conv<long>(stage_one) + index * STAGE_TWO_BLOCK;
+    return {low, std::min(low + STAGE_TWO_BLOCK, stage_two)};
+}
+
+StageTwoPrimes::StageTwoPrimes(const Bounds &bounds)
+        : StageTwoPrimes(bounds.has_stage_two() ? NTL::conv<long>(bounds.stage_one) : 0,
+                         bounds.has_stage_two() ? bounds.stage_two : 0) {
+}
+
+StageTwoPrimes::StageTwoPrimes(long low, long high) : _bound(high) {
+    if (low >= high) {
+        return;
+    }
+    auto start = low + 1;
+    if (start < NTL_SP_BOUND) {
+        _primes.reset(start);
+    }
+    _current = start - 1;
+    _first = _next_prime();
+    _current = _first;
+}
+
+bool StageTwoPrimes::next(long &gap) {
+    if (_first == 0) {
+        return false;
+    }
+    auto prime = _next_prime();
+    if (prime == 0) {
+        return false;
+    }
+    gap = prime - _current;
+    _current = prime;
+    return true;
+}
+
+long StageTwoPrimes::_next_prime() {
+    /// Returns next prime in range or 0 at the end of range
+    long prime = _current < NTL_SP_BOUND ? _primes.next() : 0;
+    if (prime == 0) {
+        prime = NTL::conv<long>(NTL::NextPrime(NTL::ZZ(_current + 1)));
+    }
+    return prime <= _bound ? prime : 0;
+}
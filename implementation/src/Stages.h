@@ -0,0 +1,126 @@
+#ifndef DIP_STAGES_H
+#define DIP_STAGES_H
+
+#include <NTL/ZZ.h>
+
+#include <utility>
+
+#include "Options.h"
+
+struct Bounds {
+    /// This struct stores bounds of both stages shared by ECM, p-1 and p+1 methods
+    NTL::ZZ stage_one;
+    /// Stage 2 goes through primes in (B1, B2], it is skipped when B2 is not bigger than B1
+    long stage_two = 0;
+
+    /// B1 is taken from options or default_bound, it is never bigger than square root of composite number.
+    /// B2 is taken from options or it is stage_two_factor * B1 (0 means no stage 2).
+    /// B2 from options which is not bigger than B1 disables stage 2.
+    Bounds(const Options &options, const NTL::ZZ &default_bound, long stage_two_factor = 0);
+
+    [[nodiscard]] bool has_stage_two() const noexcept {
+        return stage_one < stage_two;
+    }
+
+    /// Width of stage 2 block. Blocks are independent ranges of (B1, B2], so they can be processed in parallel.
+    static constexpr long STAGE_TWO_BLOCK = 1L << 20;
+
+    /// Returns number of stage 2 blocks (0 means no stage 2)
+    [[nodiscard]] long stage_two_blocks() const;
+
+    /// Returns range (low, high] of block with given index
+    [[nodiscard]] std::pair<long, long> stage_two_block(long index) const;
+};
+
+class PrimePowers final {
+    /// Generates stage 1 scalars, it is largest power p^e <= B1 for every prime p <= B1
+public:
+    explicit PrimePowers(NTL::ZZ bound) : _bound(std::move(bound)) {
+    }
+
+    /// Stores next scalar to scalar, returns false when all scalars were generated
+    bool next(NTL::ZZ &scalar);
+
+private:
+    NTL::ZZ _bound;
+    NTL::PrimeSeq _primes;
+    NTL::ZZ _prime{0};
+};
+
+class StageTwoPrimes final {
+    /// Goes through primes in (B1, B2] as gaps between consecutive primes
+public:
+    explicit StageTwoPrimes(const Bounds &bounds);
+
+    /// Goes through primes in (low, high]
+    StageTwoPrimes(long low, long high);
+
+    /// Returns first prime bigger than B1 or 0 when there is no prime in range
+    [[nodiscard]] long first() const noexcept {
+        return _first;
+    }
+
+    /// Stores difference between next prime and current prime to gap, returns false at the end of range
+    bool next(long &gap);
+
+private:
+    long _bound;
+    long _first = 0;
+    long _current = 0;
+    NTL::PrimeSeq _primes;
+
+    long _next_prime();
+};
+
+template<class Power, class Residue>
+NTL::ZZ stage_one(const Bounds &bounds, const NTL::ZZ &modulus, NTL::ZZ &value, Power power, Residue residue) {
+    /// Standard stage 1 shared by p-1 and p+1 methods. Power gets value and scalar and returns value raised
+    /// by scalar, residue gets value and returns number whose GCD with modulus is tested. GCD is computed only
+    /// at the end. When it is modulus, all factors were found at once and stage 1 is repeated from starting value
+    /// with GCD after every scalar. Returns 1, divisor of modulus or modulus itself.
+    const NTL::ZZ start = value;
+    PrimePowers scalars(bounds.stage_one);
+    for (NTL::ZZ scalar; scalars.next(scalar);) {
+        value = power(value, scalar);
+    }
+    auto divisor = NTL::GCD(residue(value), modulus);
+    if (divisor != modulus) {
+        return divisor;
+    }
+    value = start;
+    PrimePowers replay(bounds.stage_one);
+    for (NTL::ZZ scalar; replay.next(scalar);) {
+        value = power(value, scalar);
+        divisor = NTL::GCD(residue(value), modulus);
+        if (divisor != 1) {
+            return divisor;
+        }
+    }
+    return divisor;
+}
+
+template<class Start, class Step>
+NTL::ZZ stage_two_product(StageTwoPrimes &primes, const NTL::ZZ &modulus, Start start, Step step) {
+    /// Start gets first prime q and returns residue for q, step gets gap to next prime and returns residue
+    /// for that prime. Returns product of all residues modulo modulus (1 for empty range).
+    if (primes.first() == 0) {
+        return NTL::ZZ{1};
+    }
+    NTL::ZZ accumulator = start(primes.first()) % modulus;
+    long gap;
+    while (primes.next(gap)) {
+        accumulator = NTL::MulMod(accumulator, step(gap) % modulus, modulus);
+    }
+    return accumulator;
+}
+
+template<class Start, class Step>
+NTL::ZZ stage_two(const Bounds &bounds, const NTL::ZZ &modulus, Start start, Step step) {
+    /// Standard continuation shared by all methods. Residues are multiplied together and only one GCD
+    /// is computed at the end.
+    StageTwoPrimes primes(bounds);
+    return NTL::GCD(stage_two_product(primes, modulus, start, step), modulus);
+}
+
+
+#endif //DIP_STAGES_H
@@ -0,0 +1,51 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        _workers.emplace_back(&ThreadPool::_work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push(std::move(job));
+    }
+    _condition.notify_one();
+}
+
+std::size_t ThreadPool::size() const noexcept {
+    return _workers.size();
+}
+
+void ThreadPool::_work() {
+    /// Worker takes jobs until pool is stopping and queue is empty
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop();
+        }
+        job();
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef DIP_THREADPOOL_H
+#define DIP_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool final {
+    /// Simple fixed-size pool of worker threads. It can be shared by several factorizers.
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Destructor finishes all queued jobs and joins workers
+    ~ThreadPool();
+
+    /// This function queues new job for first free worker
+    void submit(std::function<void()> job);
+
+    /// Returns number of worker threads
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopping = false;
+
+    /// Main loop of worker thread
+    void _work();
+};
+
+
+#endif //DIP_THREADPOOL_H
@@ -0,0 +1,83 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+
+namespace {
+    std::atomic<std::uint64_t> next_id{1};
+
+    struct CachedBuffer {
+        std::uint64_t trace = 0;
+        void *buffer = nullptr;
+    };
+
+    /// Buffers of traces recently used by thread, entries of destroyed traces are never matched again.
+    /// It only saves lookup under mutex of trace, buffer of thread is found in trace when its entry is dropped.
+    constexpr std::size_t CACHED_BUFFERS = 16;
+    thread_local std::vector<CachedBuffer> cached;
+}
+
+Trace::Trace(int pid) : _id(next_id++), _pid(pid), _origin(std::chrono::steady_clock::now()) {
+}
+
+std::int64_t Trace::now() const noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _origin).count();
+}
+
+Trace::ThreadBuffer &Trace::_thread_buffer() {
+    auto entry = std::find_if(cached.begin(), cached.end(), [this](const CachedBuffer &c) { return c.trace == _id; });
+    if (entry != cached.end()) {
+        return *static_cast<ThreadBuffer *>(entry->buffer);
+    }
+    /// Entry of thread may have been dropped from cache while trace is alive, so buffer is looked up first
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto thread = std::this_thread::get_id();
+    auto owned = std::find_if(_buffers.begin(), _buffers.end(),
+                              [thread](const std::unique_ptr<ThreadBuffer> &b) { return b->thread == thread; });
+    if (owned == _buffers.end()) {
+        _buffers.push_back(std::make_unique<ThreadBuffer>());
+        _buffers.back()->thread = thread;
+        _buffers.back()->tid = static_cast<int>(_buffers.size() - 1);
+        _buffers.back()->events.reserve(4096);
+        owned = std::prev(_buffers.end());
+    }
+    auto &buffer = **owned;
+    if (cached.size() >= CACHED_BUFFERS) {
+        cached.erase(cached.begin());
+    }
+    cached.push_back({_id, &buffer});
+    return buffer;
+}
+
+void Trace::record(const char *name, std::int64_t start, std::int64_t end) {
+    auto &buffer = _thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({name, start, end});
+}
+
+bool Trace::write(const std::string &path) const {
+    std::ofstream output(_pid == 0 ? path : path + "." + std::to_string(_pid));
+    if (!output) {
+        return false;
+    }
+    /// Timestamps are in microseconds
+    output << std::fixed << std::setprecision(3);
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << _pid << ",\"tid\":0,\"args\":{\"name\":\"rank "
+           << _pid << "\"}}";
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto &buffer : _buffers) {
+        std::lock_guard<std::mutex> events_lock(buffer->mutex);
+        for (const auto &event : buffer->events) {
+            output << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"dip\",\"ph\":\"X\",\"pid\":" << _pid
+                   << ",\"tid\":" << buffer->tid << ",\"ts\":" << event.start / 1000.0
+                   << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output);
+}
@@ -0,0 +1,105 @@
+#ifndef DIP_TRACE_H
+#define DIP_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Trace final {
+    /// Low-overhead tracing of computation phases. Trace is owned by options of computation, so every factorizer
+    /// can have its own. Every thread records spans into its own buffer of trace, buffers are merged when trace
+    /// is written in trace event JSON format (Chrome tracing, Perfetto).
+    /// When options have no trace, span costs only one null pointer test.
+public:
+    /// pid identifies process (MPI rank) in trace
+    explicit Trace(int pid = 0);
+
+    Trace(const Trace &) = delete;
+    Trace &operator=(const Trace &) = delete;
+
+    /// Writes events of all threads to path, process with pid other than 0 writes to path.pid.
+    /// It can be called while other threads record events.
+    bool write(const std::string &path) const;
+
+    /// Records complete event of current thread, name must be string literal
+    void record(const char *name, std::int64_t start, std::int64_t end);
+
+    /// Returns time in nanoseconds since trace was created
+    [[nodiscard]] std::int64_t now() const noexcept;
+
+    /// Returns current time of trace or 0 when there is no trace
+    [[nodiscard]] static std::int64_t start(const std::shared_ptr<Trace> &trace) noexcept {
+        return trace ? trace->now() : 0;
+    }
+
+    class Span final {
+        /// Records event from construction to destruction
+    public:
+        Span(const std::shared_ptr<Trace> &trace, const char *name) noexcept
+                : _trace(trace.get()), _name(name), _start(_trace ? _trace->now() : 0) {
+        }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+        ~Span() {
+            if (_trace) {
+                _trace->record(_name, _start, _trace->now());
+            }
+        }
+
+    private:
+        Trace *_trace;
+        const char *_name;
+        std::int64_t _start;
+    };
+
+private:
+    struct Event {
+        const char *name;
+        std::int64_t start;
+        std::int64_t end;
+    };
+
+    struct ThreadBuffer {
+        std::thread::id thread;
+        int tid;
+        /// Taken by owning thread for every event and by writer, so it is almost never contended
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    /// Unique identity of trace, cached buffer of thread is never used for other trace at same address
+    const std::uint64_t _id;
+    const int _pid;
+    const std::chrono::steady_clock::time_point _origin;
+    /// Buffers are owned by trace, so events of finished threads are kept until trace is written
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+
+    /// Returns buffer of current thread, it is created on first event of thread
+    ThreadBuffer &_thread_buffer();
+};
+
+#ifdef DIP_TRACING
+#define DIP_TRACE_CONCAT_(a, b) a##b
+#define DIP_TRACE_CONCAT(a, b) DIP_TRACE_CONCAT_(a, b)
+/// Traces rest of current scope as span with given name, trace is std::shared_ptr<Trace> (may be null)
+#define TRACE_SPAN(trace, name) Trace::Span DIP_TRACE_CONCAT(trace_span_, __LINE__)(trace, name)
+/// Stores current time of trace to new variable, it is start of span recorded later by TRACE_SPAN_SINCE
+#define TRACE_START(variable, trace) const std::int64_t variable = Trace::start(trace)
+/// Records span from start to now, e.g. waiting for lock which is entered
+#define TRACE_SPAN_SINCE(trace, name, start) \
+    do { if (trace) { (trace)->record(name, start, (trace)->now()); } } while (false)
+#else
+#define TRACE_SPAN(trace, name) do {} while (false)
+#define TRACE_START(variable, trace) do {} while (false)
+#define TRACE_SPAN_SINCE(trace, name, start) do {} while (false)
+#endif
+
+
+#endif //DIP_TRACE_H
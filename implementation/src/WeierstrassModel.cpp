@@ -1,4 +1,5 @@
 #include "WeierstrassModel.h"
+#include "Trace.h"
 
 ProjectivePoint
 WeierstrassModel::add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const {
@@ -12,20 +13,20 @@ WeierstrassModel::add_points(const ProjectivePoint &P, const ProjectivePoint &Q)
         return P;
     }
 
-    NTL::ZZ A = Q.y * P.z;
-    NTL::ZZ B = P.y * Q.z;
-    NTL::ZZ C = Q.x * P.z;
-    NTL::ZZ D = P.x * Q.z;
+    NTL::ZZ A = _mul(Q.y, P.z);
+    NTL::ZZ B = _mul(P.y, Q.z);
+    NTL::ZZ C = _mul(Q.x, P.z);
+    NTL::ZZ D = _mul(P.x, Q.z);
     NTL::ZZ E = A - B;
     NTL::ZZ F = C - D;
-    NTL::ZZ G = F * F;
-    NTL::ZZ H = G * F;
-    NTL::ZZ I = P.z * Q.z;
-    NTL::ZZ J = E * E * I - H - (G << 1) * D;
+    NTL::ZZ G = _mul(F, F);
+    NTL::ZZ H = _mul(G, F);
+    NTL::ZZ I = _mul(P.z, Q.z);
+    NTL::ZZ J = _mul(_mul(E, E), I) - H - _mul(G << 1, D);
     return {
-        (F * J) % *_ecc.modulus,
-        (E * (G * D - J) - H * B) % *_ecc.modulus,
-        (H * I) % *_ecc.modulus
+        _reduce(F * J),
+        _reduce(E * (_mul(G, D) - J) - _mul(H, B)),
+        _reduce(H * I)
     };
 }
 
@@ -34,22 +35,24 @@ ProjectivePoint WeierstrassModel::double_point(const ProjectivePoint &P) const {
     if (P == INFINITY_POINT) {
         return P;
     }
-    NTL::ZZ A = _ecc.a * P.z * P.z + P.x * P.x * 3;
-    NTL::ZZ B = P.y * P.z;
-    NTL::ZZ C = P.x * P.y * B;
-    NTL::ZZ D = A * A - (C << 3);
-    return {(B * D << 1) % *_ecc.modulus,
-            (A * ((C << 2) - D) - P.y * P.y * (B << 3) * B) % *_ecc.modulus,
-            ((B * B * B) << 3) % *_ecc.modulus
+    NTL::ZZ A = _mul(_mul(_ecc.a, P.z), P.z) + _mul(P.x, P.x) * 3;
+    NTL::ZZ B = _mul(P.y, P.z);
+    NTL::ZZ C = _mul(_mul(P.x, P.y), B);
+    NTL::ZZ D = _mul(A, A) - (C << 3);
+    return {_reduce(B * D << 1),
+            _reduce(A * ((C << 2) - D) - _mul(_mul(_mul(P.y, P.y), B << 3), B)),
+            _reduce(_mul(_mul(B, B), B) << 3)
     };
 }
 
 ProjectivePoint WeierstrassModel::generate_elliptic_curve() {
+    TRACE_SPAN(_options->tracer, "generate curve");
     ProjectivePoint p;
     p.z = 1;
     if (!_ecc.modulus) {
         _ecc.modulus = _options->composite_number;
     }
+    _prepare_reducer();
     /// While duplicates or elliptic curve is singular try to generate new points and get compute elliptic curve parameters
     while (true) {
         p.x = NTL::RandomBnd(*_options->composite_number);
@@ -82,7 +85,8 @@ WeierstrassModel::EllipticCurve WeierstrassModel::get_elliptic_curve() const noe
     return _ecc;
 }
 
-void WeierstrassModel::set_elliptic_curve(const WeierstrassModel::EllipticCurve &curve) noexcept {
+void WeierstrassModel::set_elliptic_curve(const WeierstrassModel::EllipticCurve &curve) {
     _ecc = curve;
     _ecc.modulus = _options->composite_number;
+    _prepare_reducer();
 }
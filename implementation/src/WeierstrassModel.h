@@ -3,45 +3,28 @@
 
 #include <set>
 #include <utility>
-#include <boost/serialization/string.hpp>
 
 #include "AbstractModel.h"
 
 class WeierstrassModel final : public AbstractModel {
 public:
     struct EllipticCurve {
-        friend class boost::serialization::access;
-
         // Elliptic curve in Weierstrass form y^2 = x^3 + ax + b
         NTL::ZZ a;
         NTL::ZZ b;
 
         std::shared_ptr<NTL::ZZ> modulus = nullptr;
 
-        template<class Archive>
-        void save(Archive &ar, const unsigned int version) const {
-            std::stringstream buffer;
-
-            buffer << a;
-            ar & buffer.str();
-            buffer.str("");
-
-            buffer << b;
-            ar & buffer.str();
+        /// Number of values in binary format
+        static constexpr long WIRE_VALUES = 2;
+        /// Writes curve parameters in binary format and returns end of written data
+        unsigned char *to_bytes(unsigned char *buffer, long slot) const {
+            return wire::write(buffer, slot, {&a, &b});
         }
-
-        template<class Archive>
-        void load(Archive &ar, const unsigned int version) {
-            std::string value;
-
-            ar & value;
-            NTL::conv(a, value.c_str());
-
-            value.clear();
-            ar & value;
-            NTL::conv(b, value.c_str());
+        /// Reads curve parameters in binary format and returns end of read data
+        const unsigned char *from_bytes(const unsigned char *buffer, long slot) {
+            return wire::read(buffer, slot, {&a, &b});
         }
-        BOOST_SERIALIZATION_SPLIT_MEMBER()
 
         bool operator<(const EllipticCurve &rhs) const {
             return a < rhs.a || (a == rhs.a && b < rhs.b);
@@ -64,9 +47,14 @@ public:
 
     [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override;
 
+    /// Z stays divisible by factor, because neutral point modulo factor is (X : Y : 0)
+    [[nodiscard]] bool sticky_factor_coordinate() const noexcept override {
+        return true;
+    }
+
     [[nodiscard]] EllipticCurve get_elliptic_curve() const noexcept;
 
-    void set_elliptic_curve(const EllipticCurve &curve) noexcept;
+    void set_elliptic_curve(const EllipticCurve &curve);
 
 private:
 
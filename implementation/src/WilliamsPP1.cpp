@@ -0,0 +1,78 @@
+#include "WilliamsPP1.h"
+
+NTL::ZZ WilliamsPP1::factorize() const {
+    const auto &n = *_options->composite_number;
+    Bounds bounds(*_options, NTL::ZZ(WilliamsPP1::DEFAULT_BOUND), WilliamsPP1::STAGE_TWO_FACTOR);
+
+    /// Seeds 2/7 and 6/5 give group order divisible by 6 and 4, next seeds are random
+    for (int i = 0; i < WilliamsPP1::SEEDS; i++) {
+        NTL::ZZ seed;
+        if (i < 2) {
+            NTL::ZZ numerator{i == 0 ? 2 : 6}, denominator{i == 0 ? 7 : 5};
+            auto divisor = NTL::GCD(denominator, n);
+            if (divisor != 1) {
+                return divisor < n ? divisor : NTL::ZZ{0};
+            }
+            seed = NTL::MulMod(numerator, NTL::InvMod(denominator, n), n);
+        } else {
+            seed = NTL::RandomBnd(n - 3) + 3;
+        }
+        auto divisor = _factorize(bounds, seed);
+        if (divisor != 0) {
+            return divisor;
+        }
+    }
+    return NTL::ZZ{0};
+}
+
+NTL::ZZ WilliamsPP1::_factorize(const Bounds &bounds, const NTL::ZZ &seed) const {
+    const auto &n = *_options->composite_number;
+    auto v = seed;
+    auto divisor = stage_one(bounds, n, v, [&](const NTL::ZZ &value, const NTL::ZZ &scalar) {
+        return _lucas(value, scalar);
+    }, [](const NTL::ZZ &value) {
+        return value - 2;
+    });
+    if (divisor > 1 && divisor < n) {
+        return divisor;
+    }
+    if (divisor == n) {
+        return NTL::ZZ{0};
+    }
+
+    /// Stage 2 goes through odd indices m by V_{m+2} = V_m V_2 - V_{m-2} and accumulates V_q - 2 for primes q
+    auto v2 = (v * v - 2) % n;
+    NTL::ZZ previous, current;
+    divisor = stage_two(bounds, n, [&](long prime) {
+        previous = _lucas(v, NTL::ZZ(prime - 2));
+        current = _lucas(v, NTL::ZZ(prime));
+        return current - 2;
+    }, [&](long gap) {
+        for (long i = 0; i < gap; i += 2) {
+            auto next = (current * v2 - previous) % n;
+            previous = current;
+            current = next;
+        }
+        return current - 2;
+    });
+    if (divisor > 1 && divisor < n) {
+        return divisor;
+    }
+    return NTL::ZZ{0};
+}
+
+NTL::ZZ WilliamsPP1::_lucas(const NTL::ZZ &v, const NTL::ZZ &k) const {
+    /// Montgomery ladder keeps pair (V_i, V_{i+1}), V_{2i} = V_i^2 - 2 and V_{2i+1} = V_i V_{i+1} - v
+    const auto &n = *_options->composite_number;
+    NTL::ZZ low{2}, high = v;
+    for (long i = NTL::NumBits(k) - 1; i >= 0; i--) {
+        if (NTL::bit(k, i)) {
+            low = (low * high - v) % n;
+            high = (high * high - 2) % n;
+        } else {
+            high = (low * high - v) % n;
+            low = (low * low - 2) % n;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,40 @@
+#ifndef DIP_WILLIAMSPP1_H
+#define DIP_WILLIAMSPP1_H
+
+#include <NTL/ZZ.h>
+
+#include <memory>
+#include <utility>
+
+#include "Options.h"
+#include "Stages.h"
+
+class WilliamsPP1 final {
+    /// Williams p+1 method. It finds factor p when p + 1 is B1-powersmooth up to one prime in (B1, B2]
+    /// and seed A is such that A^2 - 4 is quadratic non-residue modulo p (otherwise it works as p-1 method).
+public:
+    explicit WilliamsPP1(std::shared_ptr<Options> options) : _options(std::move(options)) {
+    }
+
+    /// Default B1 when it is not set from command-line
+    static constexpr long DEFAULT_BOUND = 1000000;
+    /// Default B2 is multiple of B1
+    static constexpr long STAGE_TWO_FACTOR = 100;
+    /// Number of tried seeds, each one succeeds with probability about 1/2
+    static constexpr int SEEDS = 3;
+
+    /// This function returns found factor or 0
+    [[nodiscard]] NTL::ZZ factorize() const;
+
+private:
+    std::shared_ptr<Options> _options;
+
+    /// Runs both stages for one seed, returns found factor or 0
+    [[nodiscard]] NTL::ZZ _factorize(const Bounds &bounds, const NTL::ZZ &seed) const;
+
+    /// Computes V_k(v) of Lucas sequence V_0 = 2, V_1 = v, V_{i+1} = v V_i - V_{i-1}
+    [[nodiscard]] NTL::ZZ _lucas(const NTL::ZZ &v, const NTL::ZZ &k) const;
+};
+
+
+#endif //DIP_WILLIAMSPP1_H
@@ -1,77 +1,210 @@
+#include <fstream>
 #include <iostream>
 #include <NTL/ZZ.h>
 #include <memory>
 
 #include <boost/program_options.hpp>
 
-#include "Lenstra.h"
+#include "Factorizer.h"
 #include "Options.h"
-#include "EdwardsModel.h"
-#include "WeierstrassModel.h"
+#include "QuadraticSieve.h"
+#include "Stages.h"
+#include "Trace.h"
 
 namespace po = boost::program_options;
+namespace mpi = boost::mpi;
+
+static int factorize_batch(const std::shared_ptr<Options> &options, const std::string &path) {
+    /// Factorizes all numbers from file, factors shared between numbers are printed before ECM starts
+    std::ifstream input(path);
+    if (!input) {
+        std::cerr << "Can not open file " << path << "!\n";
+        return 4;
+    }
+    std::vector<NTL::ZZ> numbers;
+    for (NTL::ZZ number; input >> number;) {
+        if (number < 2) {
+            std::cerr << "Composite number must be positive integer bigger than 1!\n";
+            return 3;
+        }
+        numbers.push_back(number);
+    }
+    if (!input.eof()) {
+        std::cerr << "Invalid number in file " << path << "!\n";
+        return 4;
+    }
+
+    std::cout << "Factorizing " << numbers.size() << " numbers from: " << path << '\n';
+    Factorizer factorizer(options, std::make_shared<ThreadPool>());
+    auto tasks = factorizer.factor_all(numbers, 0, [&numbers](std::size_t i, const NTL::ZZ &factor) {
+        std::cout << numbers[i] << ": shared factor = " << factor << "\n";
+    });
+    int result = 0;
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+        if (!tasks[i].shared) {
+            NTL::ZZ factor;
+            try {
+                factor = tasks[i].result.get();
+            } catch (std::exception &exception) {
+                std::cerr << numbers[i] << ": " << exception.what() << "\n";
+                result = 5;
+                continue;
+            }
+            if (factor != 0) {
+                std::cout << numbers[i] << ": factor = " << factor << "\n";
+            } else {
+                std::cout << numbers[i] << ": no factor found\n";
+            }
+        }
+    }
+    return result;
+}
 
 int main(int argc, char **argv) {
     std::shared_ptr<Options> options = std::make_shared<Options>();
+    std::string batch_file;
+    bool legacy_weierstrass = false, legacy_edwards = false;
 
     po::options_description desc("OPTIONS");
     po::variables_map vm;
     desc.add_options()
             ("help,h", "produce help message")
-            ("weierstrass_model,w", po::bool_switch(&options->weierstrass), "set Weierstrass model")
-            ("edwards_model,e", po::bool_switch(&options->edwards), "set Edwards model")
+            ("weierstrass-model,w", po::bool_switch(&options->weierstrass), "set Weierstrass model")
+            ("edwards-model,e", po::bool_switch(&options->edwards), "set Edwards model")
+            ("hessian-model,H", po::bool_switch(&options->hessian), "set twisted Hessian model")
+            ("jacobi-model,j", po::bool_switch(&options->jacobi), "set Jacobi intersection model")
             ("timer,t", po::bool_switch(&options->timer), "time measurement")
             ("parallel,p", po::bool_switch(&options->parallel), "start parallel")
+            ("split-stage2", po::bool_switch(&options->split_stage_two), "in parallel mode split stage 2 of every curve between all processes (requires --bound2)")
+            ("pm1", po::bool_switch(&options->pm1), "use Pollard p-1 method instead of ECM")
+            ("pp1", po::bool_switch(&options->pp1), "use Williams p+1 method instead of ECM")
+            ("first-pass,f", po::bool_switch(&options->first_pass), "try p-1 and p+1 methods before ECM")
+            ("qs-threshold", po::value<long>(&options->qs_threshold), "Numbers with at most this many digits are factorized by quadratic sieve after short ECM for small factors, 0 disables it (Default 90)")
+            ("large-modulus-threshold", po::value<long>(&options->large_modulus_threshold), "Moduli with at least this many bits are reduced after every product in curve arithmetic, 0 disables it (Default 512)")
+            ("barrett-threshold", po::value<long>(&options->barrett_threshold), "Moduli with at least this many bits use Barrett reduction with cached reciprocal, 0 disables it (Default 16384)")
             ("bound,b", po::value<NTL::ZZ>(options->bound.get()), "Maximal bound for iterations (Default square root of composite number)")
-            ("composite-number,n", po::value<NTL::ZZ>(options->composite_number.get())->required(), "Positive integer bigger than 1 to factorize");
+            ("bound2,B", po::value<NTL::ZZ>(options->bound2.get()), "Bound for stage 2 (Default no stage 2 for ECM, 100 * bound for p-1 and p+1)")
+            ("composite-number,n", po::value<NTL::ZZ>(options->composite_number.get()), "Positive integer bigger than 1 to factorize")
+            ("trace", po::value<std::string>(&options->trace), "Write trace of computation to file in Chrome trace event format, in parallel mode every rank except 0 appends its rank to file name")
+            ("effort-db", po::value<std::string>(&options->effort_db), "File with effort database, known factors are printed immediately and ECM continues with fresh curves on bounds not finished by previous runs")
+            ("batch-file,i", po::value<std::string>(&batch_file), "File with composite numbers (one per line), factors shared between them are found by batch GCD first");
+    /// Former spellings of model options are accepted, but not shown in help
+    po::options_description legacy;
+    legacy.add_options()
+            ("weierstrass_model", po::bool_switch(&legacy_weierstrass))
+            ("edwards_model", po::bool_switch(&legacy_edwards));
+    po::options_description all;
+    all.add(desc).add(legacy);
     try {
-        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::store(po::parse_command_line(argc, argv, all), vm);
         if (vm.count("help")) {
-            std::cout << argv[0] << " [OPTIONS] --composite-number/-n COMPOSITE NUMBER\n";
+            std::cout << argv[0] << " [OPTIONS] --composite-number/-n COMPOSITE NUMBER | --batch-file/-i FILE\n";
             std::cout << desc << "\n";
             return 1;
         }
         po::notify(vm);
+        if (!vm.count("composite-number") && batch_file.empty()) {
+            throw po::required_option("composite-number");
+        }
     } catch (std::exception &exception) {
         std::cout << exception.what() << "\n";
         return 1;
     }
 
-    if (options->weierstrass && options->edwards) {
+    options->weierstrass = options->weierstrass || legacy_weierstrass;
+    options->edwards = options->edwards || legacy_edwards;
+    if (options->weierstrass + options->edwards + options->hessian + options->jacobi > 1) {
         std::cerr << "Only one model can be specified!\n";
         return 2;
     }
 
-    options->weierstrass = !options->edwards;
+    if (options->pm1 && options->pp1) {
+        std::cerr << "Only one method can be specified!\n";
+        return 2;
+    }
+
+    options->weierstrass = !options->edwards && !options->hessian && !options->jacobi;
+
+#ifndef DIP_TRACING
+    if (!options->trace.empty()) {
+        std::cerr << "Program was compiled without tracing, trace will contain no spans!\n";
+    }
+#endif
+
+    if (options->parallel && !options->effort_db.empty()) {
+        std::cerr << "Effort database can not be used in parallel mode!\n";
+        return 2;
+    }
+
+    if (!batch_file.empty()) {
+        if (options->parallel) {
+            std::cerr << "Batch file can not be used in parallel mode!\n";
+            return 2;
+        }
+        return factorize_batch(options, batch_file);
+    }
 
     if (*options->composite_number < 2) {
         std::cerr << "Composite number must be positive integer bigger than 1!\n";
         return 3;
     }
 
+    if (options->split_stage_two && !options->parallel) {
+        std::cerr << "Split stage 2 requires parallel mode!\n";
+        return 2;
+    }
+    if (options->split_stage_two && !Bounds(*options, NTL::SqrRoot(*options->composite_number)).has_stage_two()) {
+        std::cerr << "Split stage 2 requires bound2 bigger than bound!\n";
+        return 2;
+    }
+
     std::cout << "Factorizing number: " << *options->composite_number << '\n';
-    std::cout << "Using model: " << (options->edwards ? "Edwards" : "Weierstrass") << '\n';
+    bool sieve = !options->pm1 && !options->pp1 && QuadraticSieve::is_suitable(*options);
+    std::cout << "Using method: " << (options->pm1 ? "p-1" : options->pp1 ? "p+1" : sieve ? "SIQS" : "ECM") << '\n';
+    std::cout << "Using model: " << (options->hessian ? "twisted Hessian" : options->jacobi ? "Jacobi intersection"
+                                     : options->edwards ? "Edwards" : "Weierstrass") << '\n';
     std::cout << "Using timer: " << (options->timer ? "yes" : "no") << '\n';
     double start_time = 0.0, end_time;
-    std::shared_ptr<AbstractModel> model;
-    if (options->weierstrass) {
-        model = std::make_shared<WeierstrassModel>(options);
-    } else {
-        model = std::make_shared<EdwardsModel>(options);
-    }
-    Lenstra ecm(options, model);
     if (options->timer) {
         start_time = NTL::GetTime();
     }
     NTL::ZZ factor;
+    int rank = 0;
     if (!options->parallel) {
-        factor = ecm.factorize();
+        if (!options->trace.empty()) {
+            options->tracer = std::make_shared<Trace>();
+        }
+        Factorizer factorizer(options);
+        try {
+            factor = factorizer.factor(*options->composite_number).result.get();
+        } catch (std::exception &exception) {
+            std::cerr << exception.what() << "\n";
+            return 5;
+        }
     } else {
-        factor = ecm.factorize_parallel(argc, argv);
+        /// MPI environment lives for whole parallel computation
+        mpi::environment env(argc, argv, mpi::threading::multiple);
+        mpi::communicator world;
+        rank = world.rank();
+        if (!options->trace.empty()) {
+            options->tracer = std::make_shared<Trace>(rank);
+        }
+        Factorizer factorizer(options);
+        NTL::ZZ curves{0};
+        factorizer.set_progress_callback([&curves](const FactorizationProgress &progress) {
+            curves = progress.curves;
+        });
+        factor = factorizer.factor_parallel(*options->composite_number, env, world);
+        if (rank == 0 && curves != 0) {
+            std::cout << "generated ecc = " << curves << "\n";
+        }
     }
 
     end_time = NTL::GetTime();
-    if (options->timer && !options->parallel) {
+    if (options->tracer && !options->tracer->write(options->trace)) {
+        std::cerr << "Can not write trace to file " << options->trace << "!\n";
+    }
+    if (options->timer && rank == 0) {
         std::cout << "time = " << end_time - start_time << " s\n";
     }
 
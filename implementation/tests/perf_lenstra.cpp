@@ -0,0 +1,176 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include "../src/Factorizer.h"
+#include "../src/Lenstra.h"
+
+namespace pt = boost::property_tree;
+
+class CountingModel final : public AbstractModel {
+    /// Forwards everything to model and counts group operations (additions and doublings)
+public:
+    explicit CountingModel(std::shared_ptr<Options> options, std::shared_ptr<AbstractModel> model)
+            : AbstractModel(std::move(options), model->infinity_point()), _model(std::move(model)) {
+    }
+
+    [[nodiscard]] ProjectivePoint add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const override {
+        operations++;
+        return _model->add_points(P, Q);
+    }
+
+    [[nodiscard]] ProjectivePoint double_point(const ProjectivePoint &P) const override {
+        operations++;
+        return _model->double_point(P);
+    }
+
+    ProjectivePoint generate_elliptic_curve() override {
+        return _model->generate_elliptic_curve();
+    }
+
+    [[nodiscard]] bool is_infinity_point(const ProjectivePoint &point) const noexcept override {
+        return _model->is_infinity_point(point);
+    }
+
+    [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override {
+        return _model->try_get_factor(point);
+    }
+
+    [[nodiscard]] const NTL::ZZ &factor_coordinate(const ProjectivePoint &point) const noexcept override {
+        return _model->factor_coordinate(point);
+    }
+
+    [[nodiscard]] bool sticky_factor_coordinate() const noexcept override {
+        return _model->sticky_factor_coordinate();
+    }
+
+    mutable long operations = 0;
+
+private:
+    std::shared_ptr<AbstractModel> _model;
+};
+
+struct Measurement {
+    bool found = false;
+    long curves = 0;
+    double seconds = 0;
+    double ops_per_second = 0;
+};
+
+static Measurement measure(const std::string &model_name, const pt::ptree &test_case, long max_curves) {
+    /// Runs sequential ECM with fixed seed, so number of curves depends only on NTL random generator
+    auto options = std::make_shared<Options>();
+    NTL::conv(*options->composite_number, test_case.get<std::string>("n").c_str());
+    *options->bound = test_case.get<long>("bound");
+    *options->bound2 = test_case.get<long>("bound2");
+    options->edwards = model_name == "edwards";
+    options->hessian = model_name == "hessian";
+    options->jacobi = model_name == "jacobi";
+    options->weierstrass = model_name == "weierstrass";
+    if (model_name != options->model()) {
+        throw std::invalid_argument("Unknown model " + model_name);
+    }
+    options->qs_threshold = 0;
+
+    NTL::SetSeed(NTL::ZZ(test_case.get<long>("seed")));
+    auto model = std::make_shared<CountingModel>(options, Factorizer::make_model(options));
+    Lenstra ecm(options, model);
+    Measurement measurement;
+    ecm.set_progress([&](const NTL::ZZ &curves) {
+        measurement.curves = NTL::conv<long>(curves);
+        return measurement.curves < max_curves;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    auto factor = ecm.factorize();
+    measurement.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    /// Successful curve is not reported to progress, stopped run already counted all its curves
+    if (factor != 0) {
+        measurement.curves++;
+    }
+    measurement.ops_per_second = model->operations / std::max(measurement.seconds, 1e-9);
+    for (const auto &expected : test_case.get_child("factors")) {
+        NTL::ZZ expected_factor;
+        NTL::conv(expected_factor, expected.second.data().c_str());
+        measurement.found = measurement.found || expected_factor == factor;
+    }
+    return measurement;
+}
+
+int main(int argc, char **argv) {
+    /// Usage: perf_lenstra CORPUS BASELINE [--update-baseline]
+    if (argc < 3) {
+        std::cerr << argv[0] << " CORPUS BASELINE [--update-baseline]\n";
+        return 2;
+    }
+    bool update = argc > 3 && std::string(argv[3]) == "--update-baseline";
+    pt::ptree corpus, baseline;
+    pt::read_json(argv[1], corpus);
+    pt::read_json(argv[2], baseline);
+
+    /// Measured time and curves may be at most factor times worse than baseline, operations at most factor times slower
+    auto time_factor = baseline.get<double>("tolerance.seconds", 2.0);
+    auto time_slack = baseline.get<double>("tolerance.seconds_slack", 0.05);
+    auto curves_factor = baseline.get<double>("tolerance.curves", 1.5);
+    auto ops_factor = baseline.get<double>("tolerance.ops_per_second", 0.5);
+    auto max_curves = corpus.get<long>("max_curves");
+
+    pt::ptree results;
+    int failures = 0;
+    /// Every model has its own set of cases
+    for (const auto &model : corpus.get_child("sets")) {
+        for (const auto &test_case : model.second) {
+            /// Names contain no dots, '/' is used as path separator
+            pt::ptree::path_type key(model.first + "/" + test_case.second.get<std::string>("name"), '/');
+            auto measurement = measure(model.first, test_case.second, max_curves);
+            std::cout << key.dump() << ": curves = " << measurement.curves << ", time = " << measurement.seconds
+                      << " s, ops/s = " << measurement.ops_per_second;
+
+            pt::ptree result;
+            result.put("curves", measurement.curves);
+            result.put("seconds", measurement.seconds);
+            result.put("ops_per_second", measurement.ops_per_second);
+            results.put_child(key, result);
+
+            if (!measurement.found) {
+                std::cout << " FAILED (factor not found)" << std::endl;
+                failures++;
+                continue;
+            }
+            auto expected = baseline.get_child_optional(pt::ptree::path_type("results/" + key.dump(), '/'));
+            if (update) {
+                std::cout << std::endl;
+                continue;
+            }
+            if (!expected) {
+                std::cout << " FAILED (no baseline)" << std::endl;
+                failures++;
+                continue;
+            }
+            std::string regressions;
+            if (measurement.curves > expected->get<double>("curves") * curves_factor) {
+                regressions += " curves";
+            }
+            if (measurement.seconds > expected->get<double>("seconds") * time_factor + time_slack) {
+                regressions += " time";
+            }
+            if (measurement.ops_per_second < expected->get<double>("ops_per_second") * ops_factor) {
+                regressions += " ops/s";
+            }
+            if (!regressions.empty()) {
+                std::cout << " REGRESSION (" << regressions.substr(1) << ")" << std::endl;
+                failures++;
+            } else {
+                std::cout << " OK" << std::endl;
+            }
+        }
+    }
+
+    if (update) {
+        baseline.put_child("results", results);
+        pt::write_json(argv[2], baseline);
+        std::cout << "Baseline written to " << argv[2] << "\n";
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include "../src/BatchGCD.h"
+#include "../src/Factorizer.h"
+
+
+struct BatchGCDFixture {
+    BatchGCDFixture() {
+        numbers = {
+                NTL::ZZ(10007) * NTL::ZZ(100003),
+                NTL::ZZ(1009) * NTL::ZZ(1000003),
+                NTL::ZZ(10007) * NTL::ZZ(1000033),
+                NTL::ZZ(101) * NTL::ZZ(103),
+                NTL::ZZ(1009) * NTL::ZZ(1000033),
+        };
+    }
+    std::vector<NTL::ZZ> numbers;
+};
+
+BOOST_FIXTURE_TEST_SUITE(batch_gcd_test, BatchGCDFixture)
+
+BOOST_AUTO_TEST_CASE(test_one_chunk) {
+    auto divisors = BatchGCD().shared_divisors(numbers);
+    BOOST_TEST(divisors[0] == 10007);
+    BOOST_TEST(divisors[1] == 1009);
+    /// Third and fifth numbers share all their factors, so they are split by GCD with single inputs
+    BOOST_TEST((divisors[2] == 10007 || divisors[2] == 1000033));
+    BOOST_TEST(divisors[3] == 1);
+    BOOST_TEST((divisors[4] == 1009 || divisors[4] == 1000033));
+}
+
+BOOST_AUTO_TEST_CASE(test_chunks) {
+    auto expected = BatchGCD().shared_divisors(numbers);
+    for (std::size_t chunk_size = 1; chunk_size <= numbers.size(); chunk_size++) {
+        auto divisors = BatchGCD(chunk_size).shared_divisors(numbers);
+        BOOST_TEST(divisors[0] == 10007);
+        BOOST_TEST(divisors[1] == 1009);
+        for (std::size_t i = 0; i < numbers.size(); i++) {
+            BOOST_TEST((divisors[i] == 1) == (expected[i] == 1));
+            BOOST_TEST(NTL::GCD(divisors[i], numbers[i]) == divisors[i]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid_input) {
+    BOOST_TEST(BatchGCD().shared_divisors({}).empty());
+    numbers.emplace_back(0);
+    BOOST_CHECK_THROW(BatchGCD().shared_divisors(numbers), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_factor_all) {
+    Factorizer factorizer(std::make_shared<Options>());
+    auto tasks = factorizer.factor_all(numbers);
+    BOOST_TEST(tasks.size() == numbers.size());
+    BOOST_TEST((tasks[0].result.wait_for(std::chrono::seconds(0)) == std::future_status::ready));
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+        auto factor = tasks[i].result.get();
+        BOOST_TEST((factor > 1 && factor < numbers[i] && numbers[i] % factor == 0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_shared_label) {
+    /// Only numbers with common factor are labelled as shared, prime is factorized (with no factor) like others
+    Factorizer factorizer(std::make_shared<Options>());
+    const std::vector<NTL::ZZ> batch{NTL::ZZ(1000003), NTL::ZZ(1009) * NTL::ZZ(1000033),
+                                     NTL::ZZ(1009) * NTL::ZZ(1000037)};
+    std::vector<std::size_t> reported;
+    auto tasks = factorizer.factor_all(batch, 0, [&](std::size_t i, const NTL::ZZ &factor) {
+        BOOST_TEST(factor == 1009);
+        reported.push_back(i);
+    });
+    BOOST_TEST((reported == std::vector<std::size_t>{1, 2}));
+    BOOST_TEST(!tasks[0].shared);
+    BOOST_TEST(tasks[1].shared);
+    BOOST_TEST(tasks[2].shared);
+    BOOST_TEST(tasks[0].result.get() == 0);
+    BOOST_TEST(tasks[1].result.get() == 1009);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
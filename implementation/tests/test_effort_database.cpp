@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include "../src/EffortDatabase.h"
+#include "../src/Factorizer.h"
+#include "../src/PollardPM1.h"
+
+
+struct EffortDatabaseFixture {
+    EffortDatabaseFixture() {
+        std::remove(path.c_str());
+    }
+    ~EffortDatabaseFixture() {
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+    const std::string path = "test_effort.db";
+    NTL::ZZ n = NTL::ZZ(1009) * NTL::ZZ(1000003);
+};
+
+BOOST_FIXTURE_TEST_SUITE(effort_database_test, EffortDatabaseFixture)
+
+BOOST_AUTO_TEST_CASE(test_records) {
+    {
+        EffortDatabase database(path);
+        BOOST_TEST(database.find(n).factors.empty());
+        database.add_factor(n, NTL::ZZ(1009));
+        database.add_factor(n, NTL::ZZ(1009));
+        database.add_seed(n, 42);
+        database.add_curves(n, "edwards", 2000, 10);
+        database.add_curves(n, "edwards", 2000, 5);
+    }
+    auto record = EffortDatabase(path).find(n);
+    BOOST_TEST(record.factors.size() == 1);
+    BOOST_TEST(record.factor_of(n) == 1009);
+    BOOST_TEST(record.seeds.size() == 1);
+    BOOST_TEST(record.curves["edwards"][2000] == 15);
+    BOOST_TEST(EffortDatabase::fresh_seed(record) != 42);
+}
+
+BOOST_AUTO_TEST_CASE(test_levels) {
+    EffortDatabase::Record record;
+    auto level = EffortDatabase::next_level(record, "weierstrass");
+    BOOST_TEST(level.first.bound == EffortDatabase::LEVELS[0].bound);
+    BOOST_TEST(level.second == EffortDatabase::LEVELS[0].curves);
+
+    /// Curves with bigger bound count also for smaller levels
+    record.curves["weierstrass"][EffortDatabase::LEVELS[1].bound] = EffortDatabase::LEVELS[0].curves;
+    record.curves["weierstrass"][EffortDatabase::LEVELS[0].bound] = 5;
+    level = EffortDatabase::next_level(record, "weierstrass");
+    BOOST_TEST(level.first.bound == EffortDatabase::LEVELS[1].bound);
+    BOOST_TEST(level.second == EffortDatabase::LEVELS[1].curves - EffortDatabase::LEVELS[0].curves);
+    BOOST_TEST(EffortDatabase::next_level(record, "edwards").first.bound == EffortDatabase::LEVELS[0].bound);
+
+    record.curves["weierstrass"][EffortDatabase::LEVELS.back().bound] = EffortDatabase::LEVELS.back().curves;
+    BOOST_TEST(EffortDatabase::next_level(record, "weierstrass").second == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_factorizer) {
+    auto options = std::make_shared<Options>();
+    options->effort_db = path;
+    Factorizer factorizer(options);
+    /// Any of both prime factors can be found first
+    auto factor = factorizer.factor(n).result.get();
+    BOOST_TEST((factor == 1009 || factor == 1000003));
+    auto record = EffortDatabase(path).find(n);
+    BOOST_TEST(record.factor_of(n) == factor);
+    BOOST_TEST(record.seeds.size() >= 1);
+
+    /// Known factor is returned without any curve
+    NTL::ZZ hard = NTL::ZZ(1000003) * NTL::ZZ(1000033) * NTL::ZZ(1000037) * NTL::ZZ(1000039);
+    EffortDatabase(path).add_factor(hard, NTL::ZZ(1000037));
+    options->qs_threshold = 0;
+    BOOST_TEST(factorizer.factor(hard, 1).result.get() == 1000037);
+    BOOST_TEST(EffortDatabase(path).find(hard).seeds.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_methods) {
+    /// Finished p-1 without factor is stored and skipped by next run with same bounds.
+    /// Both factors are safe primes, 1019 - 1 = 2 * 509 and 1000667 - 1 = 2 * 500333.
+    const NTL::ZZ safe = NTL::ZZ(1019) * NTL::ZZ(1000667);
+    auto options = std::make_shared<Options>();
+    options->effort_db = path;
+    options->pm1 = true;
+    *options->bound = 10;
+    *options->bound2 = 20;
+    Factorizer factorizer(options);
+    BOOST_TEST(factorizer.factor(safe).result.get() == 0);
+    const auto key = EffortDatabase::method_key("pm1", NTL::ZZ(10), NTL::ZZ(20));
+    BOOST_TEST(EffortDatabase(path).find(safe).has_method(key));
+
+    /// Stored run is not repeated even though its bound finds factor
+    *options->bound = 600;
+    *options->bound2 = 0;
+    *options->composite_number = safe;
+    BOOST_TEST(PollardPM1(options).factorize() == 1019);
+    EffortDatabase(path).add_method(safe, EffortDatabase::method_key("pm1", NTL::ZZ(600), NTL::ZZ(0)));
+    Factorizer skipping(options);
+    BOOST_TEST(skipping.factor(safe).result.get() == 0);
+    EffortDatabase(path).add_method(safe, key);
+    BOOST_TEST(EffortDatabase(path).find(safe).methods.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_failed_save) {
+    /// Database can not replace directory, error is reported instead of lost update
+    const std::string directory = "test_effort_dir.db";
+    std::filesystem::create_directory(directory);
+    BOOST_CHECK_THROW(EffortDatabase(directory).add_seed(n, 42), std::runtime_error);
+    BOOST_TEST(!std::filesystem::exists(directory + ".tmp"));
+    std::filesystem::remove(directory);
+    std::filesystem::remove(directory + ".lock");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+#include "../src/Factorizer.h"
+
+
+struct FactorizerFixture {
+    FactorizerFixture() {
+        options = std::make_shared<Options>();
+        pool = std::make_shared<ThreadPool>(2);
+    }
+    std::shared_ptr<Options> options;
+    std::shared_ptr<ThreadPool> pool;
+};
+
+BOOST_FIXTURE_TEST_SUITE(factorizer_test, FactorizerFixture)
+
+BOOST_AUTO_TEST_CASE(test_factor) {
+    Factorizer factorizer(options, pool);
+    auto result = factorizer.factor(NTL::ZZ(1000730021)).result.get();
+    BOOST_TEST((result == 100003 || result == 10007));
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_factorizations) {
+    Factorizer factorizer(options, pool);
+    auto first = factorizer.factor(NTL::ZZ(1000730021));
+    auto second = factorizer.factor(NTL::ZZ(1009003027)); // 1009 * 1000003
+    auto first_result = first.result.get();
+    auto second_result = second.result.get();
+    BOOST_TEST((first_result == 100003 || first_result == 10007));
+    BOOST_TEST((second_result == 1009 || second_result == 1000003));
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel) {
+    Factorizer factorizer(options, pool);
+    NTL::ZZ n;
+    /// Product of two 30 digits primes can not be factorized by this bound in reasonable time
+    NTL::conv(n, "70000000000000000000000000226600000000000000000000000010527");
+    *options->bound = 1000;
+    options->qs_threshold = 0;
+    std::atomic_int calls{0};
+    factorizer.set_progress_callback([&calls](const FactorizationProgress &) { calls++; });
+    auto task = factorizer.factor(n);
+    while (calls.load() == 0) {
+        std::this_thread::yield();
+    }
+    task.cancel();
+    BOOST_TEST(task.result.get() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_stage_one) {
+    /// Stage 1 of the first curve takes very long by this bound, so cancellation is noticed after one of its phases
+    Factorizer factorizer(options, pool);
+    NTL::ZZ n;
+    NTL::conv(n, "70000000000000000000000000226600000000000000000000000010527");
+    *options->bound = 1000000000;
+    options->qs_threshold = 0;
+    std::atomic_int calls{0};
+    factorizer.set_progress_callback([&calls](const FactorizationProgress &) { calls++; });
+    auto task = factorizer.factor(n);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    task.cancel();
+    BOOST_TEST(task.result.get() == 0);
+    BOOST_TEST(calls.load() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_sieve) {
+    /// Sieve is cancelled after ECM pretest when it reports first relations
+    Factorizer factorizer(options, pool);
+    NTL::ZZ n;
+    NTL::conv(n, "70000000000000000000000000226600000000000000000000000010527");
+    std::atomic_int sieve_calls{0};
+    factorizer.set_progress_callback([&sieve_calls](const FactorizationProgress &progress) {
+        if (progress.relations > 0) {
+            sieve_calls++;
+        }
+    });
+    auto task = factorizer.factor(n);
+    while (sieve_calls.load() == 0) {
+        std::this_thread::yield();
+    }
+    task.cancel();
+    BOOST_TEST(task.result.get() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_effort) {
+    Factorizer factorizer(options, pool);
+    NTL::ZZ n;
+    NTL::conv(n, "70000000000000000000000000226600000000000000000000000010527");
+    *options->bound = 100;
+    options->qs_threshold = 0;
+    NTL::ZZ curves;
+    factorizer.set_progress_callback([&curves](const FactorizationProgress &progress) { curves = progress.curves; });
+    BOOST_TEST(factorizer.factor(n, 5).result.get() == 0);
+    BOOST_TEST(curves == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_prime) {
+    Factorizer factorizer(options, pool);
+    BOOST_TEST(factorizer.factor(NTL::ZZ(100003)).result.get() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,7 +1,10 @@
 #include <boost/test/unit_test.hpp>
+#include <map>
 #include "../src/Lenstra.h"
 #include "../src/WeierstrassModel.h"
 #include "../src/EdwardsModel.h"
+#include "../src/HessianModel.h"
+#include "../src/JacobiIntersectionModel.h"
 
 
 struct TestFixture {
@@ -11,10 +14,59 @@ struct TestFixture {
         *options->composite_number = NTL::ZZ(1000730021);
         weierstrass_model = std::make_shared<WeierstrassModel>(options);
         edwards_model = std::make_shared<EdwardsModel>(options);
+        hessian_model = std::make_shared<HessianModel>(options);
+        jacobi_model = std::make_shared<JacobiIntersectionModel>(options);
     }
     std::shared_ptr<Options> options;
     std::shared_ptr<AbstractModel> weierstrass_model;
     std::shared_ptr<AbstractModel> edwards_model;
+    std::shared_ptr<AbstractModel> hessian_model;
+    std::shared_ptr<AbstractModel> jacobi_model;
+};
+
+class TransientEdwardsModel final : public AbstractModel {
+    /// Edwards model whose factor coordinate is divisible by factor only in results of marked scalars,
+    /// such divisibility is lost by the next scalar like coordinate of model which is not sticky
+public:
+    TransientEdwardsModel(const std::shared_ptr<Options> &options, std::map<long, NTL::ZZ> marks)
+            : AbstractModel(options, EdwardsModel(options).infinity_point()), _model(options),
+              _marks(std::move(marks)) {
+    }
+
+    [[nodiscard]] ProjectivePoint add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const override {
+        return _model.add_points(P, Q);
+    }
+
+    [[nodiscard]] ProjectivePoint double_point(const ProjectivePoint &P) const override {
+        return _model.double_point(P);
+    }
+
+    [[nodiscard]] ProjectivePoint mul_points(const NTL::ZZ &k, const ProjectivePoint &P) const override {
+        auto result = _model.mul_points(k, P);
+        auto mark = _marks.find(NTL::conv<long>(k));
+        result.t = mark == _marks.end() ? NTL::ZZ{1} : mark->second;
+        return result;
+    }
+
+    ProjectivePoint generate_elliptic_curve() override {
+        return _model.generate_elliptic_curve();
+    }
+
+    [[nodiscard]] bool is_infinity_point(const ProjectivePoint &point) const noexcept override {
+        return _model.is_infinity_point(point);
+    }
+
+    [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override {
+        return NTL::GCD(point.t, *_options->composite_number);
+    }
+
+    [[nodiscard]] const NTL::ZZ &factor_coordinate(const ProjectivePoint &point) const noexcept override {
+        return point.t;
+    }
+
+private:
+    EdwardsModel _model;
+    std::map<long, NTL::ZZ> _marks;
 };
 
 BOOST_FIXTURE_TEST_SUITE(lenstra_test, TestFixture)
@@ -31,4 +83,109 @@ BOOST_AUTO_TEST_CASE(test_edwards) {
     BOOST_TEST((result == 100003 || result == 10007));
 }
 
+BOOST_AUTO_TEST_CASE(test_hessian) {
+    Lenstra test(options, hessian_model);
+    auto result = test.factorize();
+    BOOST_TEST((result == 100003 || result == 10007));
+}
+
+BOOST_AUTO_TEST_CASE(test_jacobi_intersection) {
+    Lenstra test(options, jacobi_model);
+    auto result = test.factorize();
+    BOOST_TEST((result == 100003 || result == 10007));
+}
+
+BOOST_AUTO_TEST_CASE(test_group_law) {
+    /// Unified addition of point with itself is doubling and 2(2P) = (P + 2P) + P for both new models
+    *options->composite_number = NTL::ZZ(1000003);
+    for (const auto &model : {hessian_model, jacobi_model}) {
+        auto point = model->generate_elliptic_curve();
+        auto twice = model->double_point(point);
+        auto sum = model->add_points(point, point);
+        BOOST_TEST(model->try_get_factor(sum) == 1);
+        /// Projective coordinates are compared by cross products
+        BOOST_TEST(NTL::MulMod(sum.x, twice.z, NTL::ZZ(1000003)) == NTL::MulMod(twice.x, sum.z, NTL::ZZ(1000003)));
+        BOOST_TEST(NTL::MulMod(sum.y, twice.z, NTL::ZZ(1000003)) == NTL::MulMod(twice.y, sum.z, NTL::ZZ(1000003)));
+        auto left = model->double_point(twice);
+        auto right = model->add_points(model->add_points(point, twice), point);
+        BOOST_TEST(NTL::MulMod(left.x, right.z, NTL::ZZ(1000003)) == NTL::MulMod(right.x, left.z, NTL::ZZ(1000003)));
+        BOOST_TEST(NTL::MulMod(left.y, right.z, NTL::ZZ(1000003)) == NTL::MulMod(right.y, left.z, NTL::ZZ(1000003)));
+        BOOST_TEST(model->is_infinity_point(model->mul_points(NTL::ZZ(0), point)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_wire_format) {
+    /// Point with all coordinates and curve survive binary round trip
+    auto point = jacobi_model->generate_elliptic_curve();
+    auto curve = dynamic_cast<JacobiIntersectionModel*>(jacobi_model.get())->get_elliptic_curve();
+    auto slot = NTL::NumBytes(*options->composite_number);
+    std::vector<unsigned char> wire(slot * (ProjectivePoint::WIRE_VALUES + JacobiIntersectionModel::EllipticCurve::WIRE_VALUES));
+    BOOST_TEST((curve.to_bytes(point.to_bytes(wire.data(), slot), slot) == wire.data() + wire.size()));
+
+    ProjectivePoint received;
+    JacobiIntersectionModel::EllipticCurve received_curve;
+    received_curve.from_bytes(received.from_bytes(wire.data(), slot), slot);
+    BOOST_TEST((received == point));
+    BOOST_TEST(received_curve.a == curve.a);
+}
+
+BOOST_AUTO_TEST_CASE(test_backtracking) {
+    /// Both factors are found in the same phase of stage 1 almost always, accumulated GCD is N then
+    *options->composite_number = NTL::ZZ(10007) * NTL::ZZ(10009);
+    for (const auto &model : {weierstrass_model, edwards_model, hessian_model, jacobi_model}) {
+        Lenstra test(options, model);
+        auto result = test.factorize();
+        BOOST_TEST((result == 10007 || result == 10009));
+    }
+
+    /// Wrapped Edwards model does not declare sticky coordinate. Both factors are found in the first of two segments
+    /// of the phase, checkpoint of the second segment is coprime to N, but the first segment must be replayed anyway.
+    const NTL::ZZ p(1000003), q(1000033);
+    *options->composite_number = p * q;
+    *options->bound = 10000;
+    Lenstra test(options, std::make_shared<TransientEdwardsModel>(options, std::map<long, NTL::ZZ>{{101, p}, {211, q}}));
+    test.set_progress([](const NTL::ZZ &) { return false; });
+    BOOST_TEST(test.factorize() == p);
+}
+
+BOOST_AUTO_TEST_CASE(test_barrett_reducer) {
+    /// Results are same as of division also for negative values and values bigger than square of modulus
+    NTL::ZZ n;
+    NTL::conv(n, "1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000007");
+    BarrettReducer reducer(n);
+    for (long i = 0; i < 1000; i++) {
+        auto a = NTL::RandomBnd(n), b = NTL::RandomBnd(n);
+        auto value = a * b * (i % 7 + 1) - (i % 2 ? n * n : NTL::ZZ{0});
+        BOOST_TEST(reducer.reduce(value) == value % n);
+        BOOST_TEST(reducer.reduce(-value) == -value % n);
+        BOOST_TEST(reducer.mul(a, b) == NTL::MulMod(a, b, n));
+    }
+    auto huge = NTL::RandomBnd(n * n * n);
+    BOOST_TEST(reducer.reduce(huge) == huge % n);
+}
+
+BOOST_AUTO_TEST_CASE(test_large_modulus_path) {
+    /// Every model computes same point with every product reduced as with reduction of results only
+    NTL::conv(*options->composite_number, "12345678901234567890123456789012345678901234567890123456789012345678901");
+    const NTL::ZZ scalar = NTL::ZZ(1000003) * NTL::ZZ(999983) * NTL::ZZ(65537);
+    std::vector<std::function<std::shared_ptr<AbstractModel>()>> factories{
+            [&]() { return std::make_shared<WeierstrassModel>(options); },
+            [&]() { return std::make_shared<EdwardsModel>(options); },
+            [&]() { return std::make_shared<HessianModel>(options); },
+            [&]() { return std::make_shared<JacobiIntersectionModel>(options); }};
+    for (const auto &factory : factories) {
+        std::vector<ProjectivePoint> results;
+        /// Results only, every product by division and every product by Barrett reduction
+        for (const auto &thresholds : {std::make_pair(0L, 0L), std::make_pair(1L, 0L), std::make_pair(1L, 1L)}) {
+            options->large_modulus_threshold = thresholds.first;
+            options->barrett_threshold = thresholds.second;
+            NTL::SetSeed(NTL::ZZ(42));
+            auto model = factory();
+            results.push_back(model->mul_points(scalar, model->generate_elliptic_curve()));
+        }
+        BOOST_TEST((results[0] == results[1]));
+        BOOST_TEST((results[0] == results[2]));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <boost/test/unit_test.hpp>
+#include "../src/Lenstra.h"
+#include "../src/PollardPM1.h"
+#include "../src/Stages.h"
+#include "../src/WilliamsPP1.h"
+
+
+class CyclicModel final : public AbstractModel {
+    /// Cyclic group of prime order q written additively, X is multiple of generator modulo q.
+    /// Z is factor p of composite number exactly when point is neutral, so ECM finds p when q divides scalar.
+public:
+    CyclicModel(const std::shared_ptr<Options> &options, NTL::ZZ q, NTL::ZZ p)
+            : AbstractModel(options, {NTL::ZZ{0}, NTL::ZZ{1}, NTL::ZZ{1}}), _q(std::move(q)), _p(std::move(p)) {
+    }
+
+    [[nodiscard]] ProjectivePoint add_points(const ProjectivePoint &P, const ProjectivePoint &Q) const override {
+        return _point((P.x + Q.x) % _q);
+    }
+
+    [[nodiscard]] ProjectivePoint double_point(const ProjectivePoint &P) const override {
+        return _point((P.x << 1) % _q);
+    }
+
+    [[nodiscard]] ProjectivePoint mul_points(const NTL::ZZ &k, const ProjectivePoint &P) const override {
+        return _point(NTL::MulMod(k % _q, P.x, _q));
+    }
+
+    ProjectivePoint generate_elliptic_curve() override {
+        return _point(NTL::ZZ{1});
+    }
+
+    [[nodiscard]] NTL::ZZ try_get_factor(const ProjectivePoint &point) const noexcept override {
+        return NTL::GCD(point.z, *_options->composite_number);
+    }
+
+private:
+    NTL::ZZ _q, _p;
+
+    [[nodiscard]] ProjectivePoint _point(NTL::ZZ x) const {
+        bool neutral = NTL::IsZero(x);
+        return {std::move(x), NTL::ZZ{1}, neutral ? _p : NTL::ZZ{1}};
+    }
+};
+
+struct MethodsFixture {
+    MethodsFixture() {
+        options = std::make_shared<Options>();
+        options->weierstrass = true;
+        *options->bound = 1000;
+        /// Other factor q has q - 1 and q + 1 with big prime divisors
+        NTL::conv(q, "15421666212215429531");
+    }
+    void set_number(const char *p) {
+        NTL::conv(this->p, p);
+        *options->composite_number = this->p * q;
+    }
+    std::shared_ptr<Options> options;
+    NTL::ZZ p, q;
+};
+
+BOOST_FIXTURE_TEST_SUITE(methods_test, MethodsFixture)
+
+BOOST_AUTO_TEST_CASE(test_prime_powers) {
+    PrimePowers scalars(NTL::ZZ(10));
+    std::vector<long> generated;
+    for (NTL::ZZ scalar; scalars.next(scalar);) {
+        generated.push_back(NTL::conv<long>(scalar));
+    }
+    BOOST_TEST(generated == std::vector<long>({8, 9, 5, 7}), boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_stage_two_primes) {
+    *options->composite_number = NTL::ZZ(1000000);
+    *options->bound = 0;
+    *options->bound2 = 30;
+    Bounds bounds(*options, NTL::ZZ(10));
+    StageTwoPrimes primes(bounds);
+    std::vector<long> generated{primes.first()};
+    for (long gap; primes.next(gap);) {
+        generated.push_back(generated.back() + gap);
+    }
+    BOOST_TEST(generated == std::vector<long>({11, 13, 17, 19, 23, 29}), boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_stage_two_blocks) {
+    /// Blocks split stage 2 without gaps and overlaps, so their products give same result as whole range
+    NTL::conv(*options->composite_number, "100000000000000000000");
+    *options->bound = 1000;
+    *options->bound2 = 3 * Bounds::STAGE_TWO_BLOCK;
+    Bounds bounds(*options, NTL::ZZ(10));
+    BOOST_TEST(bounds.stage_two_blocks() == 3);
+    BOOST_TEST(bounds.stage_two_block(2).second == bounds.stage_two);
+
+    const NTL::ZZ modulus(1000000007);
+    auto start = [](long q) { return NTL::ZZ(q); };
+    long prime = 0;
+    auto step = [&prime](long gap) { return NTL::ZZ(prime += gap); };
+    StageTwoPrimes primes(bounds);
+    prime = primes.first();
+    auto expected = stage_two_product(primes, modulus, start, step);
+
+    NTL::ZZ product(1);
+    for (long block = 0; block < bounds.stage_two_blocks(); block++) {
+        auto range = bounds.stage_two_block(block);
+        StageTwoPrimes block_primes(range.first, range.second);
+        prime = block_primes.first();
+        product = NTL::MulMod(product, stage_two_product(block_primes, modulus, start, step), modulus);
+    }
+    BOOST_TEST(product == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_stage_two_factor) {
+    /// Group order 2500009 is prime in third block of stage 2, so only stage 2 over all blocks finds factor
+    const NTL::ZZ p(1000003), order(2500009);
+    *options->composite_number = p * NTL::ZZ(1000033);
+    *options->bound = 1000;
+    *options->bound2 = 3 * Bounds::STAGE_TWO_BLOCK;
+    BOOST_TEST(Bounds(*options, NTL::ZZ(1000)).stage_two_blocks() == 3);
+    BOOST_TEST(Bounds(*options, NTL::ZZ(1000)).stage_two_block(2).first < 2500009);
+    Lenstra test(options, std::make_shared<CyclicModel>(options, order, p));
+    test.set_progress([](const NTL::ZZ &) { return false; });
+    BOOST_TEST(test.factorize() == p);
+
+    /// First two blocks do not contain order
+    *options->bound2 = 2 * Bounds::STAGE_TWO_BLOCK;
+    BOOST_TEST(test.factorize() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_pm1) {
+    /// p - 1 is 1000-powersmooth
+    set_number("664395018621418991");
+    BOOST_TEST(PollardPM1(options).factorize() == p);
+}
+
+BOOST_AUTO_TEST_CASE(test_pm1_stage_two) {
+    /// p - 1 is 1000-powersmooth except prime 18013
+    set_number("1106391640132594577744183");
+    *options->bound2 = 1000;
+    BOOST_TEST(PollardPM1(options).factorize() == 0);
+    *options->bound2 = 100000;
+    BOOST_TEST(PollardPM1(options).factorize() == p);
+}
+
+BOOST_AUTO_TEST_CASE(test_pp1) {
+    /// p + 1 is 1000-powersmooth
+    set_number("123946127819815238851");
+    BOOST_TEST(WilliamsPP1(options).factorize() == p);
+    BOOST_TEST(PollardPM1(options).factorize() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_all_factors_at_once) {
+    /// p - 1, p + 1, q - 1 and q + 1 are all 1000-powersmooth, so one GCD at the end of stage 1 is N for any seed
+    /// and both methods find factor only by repeating stage 1 with GCD after every scalar
+    const NTL::ZZ p(173308389983), q(273743722699);
+    *options->composite_number = p * q;
+    *options->bound2 = 0;
+    for (const auto &factor : {PollardPM1(options).factorize(), WilliamsPP1(options).factorize()}) {
+        BOOST_TEST((factor == p || factor == q));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_ecm_stage_two) {
+    *options->composite_number = NTL::ZZ(1000730021);
+    *options->bound = 50;
+    *options->bound2 = 20000;
+    Lenstra test(options, std::make_shared<WeierstrassModel>(options));
+    auto result = test.factorize();
+    BOOST_TEST((result == 100003 || result == 10007));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
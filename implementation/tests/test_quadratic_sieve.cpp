@@ -0,0 +1,40 @@
+#include <boost/test/unit_test.hpp>
+#include "../src/QuadraticSieve.h"
+
+
+struct QuadraticSieveFixture {
+    QuadraticSieveFixture() {
+        options = std::make_shared<Options>();
+    }
+    NTL::ZZ factorize(const char *p, const char *q) {
+        NTL::conv(this->p, p);
+        NTL::conv(this->q, q);
+        *options->composite_number = this->p * this->q;
+        return QuadraticSieve(options).factorize();
+    }
+    std::shared_ptr<Options> options;
+    NTL::ZZ p, q;
+};
+
+BOOST_FIXTURE_TEST_SUITE(quadratic_sieve_test, QuadraticSieveFixture)
+
+BOOST_AUTO_TEST_CASE(test_threshold) {
+    *options->composite_number = NTL::ZZ(1000730021);
+    BOOST_TEST(!QuadraticSieve::is_suitable(*options));
+    NTL::conv(*options->composite_number, "70000000000000000000000000226600000000000000000000000010527");
+    BOOST_TEST(QuadraticSieve::is_suitable(*options));
+    options->qs_threshold = 40;
+    BOOST_TEST(!QuadraticSieve::is_suitable(*options));
+}
+
+BOOST_AUTO_TEST_CASE(test_20_digits) {
+    auto result = factorize("9999999967", "10000000019");
+    BOOST_TEST((result == p || result == q));
+}
+
+BOOST_AUTO_TEST_CASE(test_40_digits) {
+    auto result = factorize("10000000000000000051", "10000000000000000087");
+    BOOST_TEST((result == p || result == q));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
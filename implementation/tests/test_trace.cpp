@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include "../src/Lenstra.h"
+#include "../src/Trace.h"
+
+
+struct TraceFixture {
+    TraceFixture() {
+        options = std::make_shared<Options>();
+        *options->composite_number = NTL::ZZ(1009) * NTL::ZZ(1000003);
+        options->weierstrass = true;
+        options->tracer = std::make_shared<Trace>();
+    }
+    ~TraceFixture() {
+        std::remove(path.c_str());
+    }
+    std::string read(const Trace &trace) const {
+        BOOST_TEST(trace.write(path));
+        std::ifstream input(path);
+        return {(std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>()};
+    }
+    const std::string path = "test_trace.json";
+    std::shared_ptr<Options> options;
+};
+
+BOOST_FIXTURE_TEST_SUITE(trace_test, TraceFixture)
+
+BOOST_AUTO_TEST_CASE(test_trace) {
+    Lenstra ecm(options, std::make_shared<WeierstrassModel>(options));
+    BOOST_TEST(ecm.factorize() == 1009);
+    std::thread([this] {
+        TRACE_SPAN(options->tracer, "other thread");
+    }).join();
+
+    auto trace = read(*options->tracer);
+    BOOST_TEST(trace.find("\"traceEvents\"") != std::string::npos);
+#ifdef DIP_TRACING
+    BOOST_TEST(trace.find("\"name\":\"generate curve\"") != std::string::npos);
+    BOOST_TEST(trace.find("\"name\":\"stage 1\"") != std::string::npos);
+    BOOST_TEST(trace.find("\"name\":\"phase\"") != std::string::npos);
+    BOOST_TEST(trace.find("\"name\":\"gcd\"") != std::string::npos);
+    BOOST_TEST(trace.find("\"name\":\"other thread\"") != std::string::npos);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_separate_traces) {
+    /// Computation without trace in its options records nothing to trace of other computation
+    auto untraced = std::make_shared<Options>(*options);
+    untraced->tracer = nullptr;
+    Lenstra ecm(untraced, std::make_shared<WeierstrassModel>(untraced));
+    BOOST_TEST(ecm.factorize() == 1009);
+    {
+        TRACE_SPAN(options->tracer, "traced");
+    }
+    auto trace = read(*options->tracer);
+    BOOST_TEST(trace.find("\"name\":\"stage 1\"") == std::string::npos);
+#ifdef DIP_TRACING
+    BOOST_TEST(trace.find("\"name\":\"traced\"") != std::string::npos);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_many_traces) {
+    /// Thread recording to more traces than it caches keeps one buffer in every trace
+    std::vector<std::shared_ptr<Trace>> traces;
+    for (int i = 0; i < 20; i++) {
+        traces.push_back(std::make_shared<Trace>());
+    }
+    for (int round = 0; round < 3; round++) {
+        for (const auto &trace : traces) {
+            TRACE_SPAN(trace, "rotation");
+        }
+    }
+    auto trace = read(*traces.front());
+    BOOST_TEST(trace.find("\"tid\":1") == std::string::npos);
+#ifdef DIP_TRACING
+    BOOST_TEST(trace.find("\"tid\":0,\"ts\"") != std::string::npos);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_write_while_recording) {
+    /// Trace is written while other thread keeps recording into its buffer
+    std::atomic_int recorded{0};
+    std::thread recorder([&] {
+        for (; recorded.load() < 100000; recorded++) {
+            TRACE_SPAN(options->tracer, "recording");
+        }
+    });
+    while (recorded.load() < 1000) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 5; i++) {
+        BOOST_TEST(read(*options->tracer).find("\"traceEvents\"") != std::string::npos);
+    }
+    recorder.join();
+#ifdef DIP_TRACING
+    auto trace = read(*options->tracer);
+    std::size_t events = 0;
+    for (auto position = trace.find("\"recording\""); position != std::string::npos;
+         position = trace.find("\"recording\"", position + 1)) {
+        events++;
+    }
+    BOOST_TEST(events == 100000);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()